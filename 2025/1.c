@@ -1,14 +1,24 @@
+#include <parse.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  char c;
-  int d;
+void solve_1(const Input *input, Result *result) {
+  // rotations are applied as they are parsed
+  PROF_PHASE("solve");
+  const char *p = input->data;
+  const char *end = input->data + input->len;
   int x0 = 50;
   int count1 = 0;
   int count2 = 0;
-  while (fscanf(file, "%c%d\n", &c, &d) == 2) {
+  while (p < end) {
+    // one rotation per line: a direction letter and a distance
+    char c = *p++;
+    long d;
+    if (!(p = parse_record(p, end, 0, &d, 1))) {
+      break;
+    }
     switch (c) {
     case 'R': {
       x0 += d;
@@ -30,8 +40,8 @@ int main(int argc, char **argv) {
     x0 = (x0 % 100 + 100) % 100;
     count1 += (x0 == 0);
   }
-  printf("%d\n", count1);
-  printf("%d\n", count2);
-  fclose(file);
-  return 0;
+  Result_add(result, "%d", count1);
+  Result_add(result, "%d", count2);
 }
+
+SOLVE_MAIN(solve_1)
@@ -1,54 +1,51 @@
 #include <assert.h>
 #include <ctype.h>
 #include <glpk.h>
+#include <parse.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-unsigned long parse_goal1(const char *token) {
-  char *p = token;
-  p++;
+// Reads the next number in [*p, end), skipping the brackets and commas
+// before it.
+static bool next_number(const char **p, const char *end,
+                        unsigned long *value) {
+  while (*p < end && !isdigit(**p)) {
+    (*p)++;
+  }
+  return (*p = parse_uint(*p, end, value)) != NULL;
+}
+
+static unsigned long parse_goal1(const char *token, size_t len) {
   unsigned long x = 0;
-  while (*p == '.' || *p == '#') {
-    if (*p == '#') {
-      x |= 1 << (p - token - 1);
+  for (size_t i = 1; i + 1 < len; i++) {
+    if (token[i] == '#') {
+      x |= 1 << (i - 1);
     }
-    p++;
   }
   return x;
 }
 
-void parse_goal2(const char *token, int *goal2) {
-  char *p = token;
-  p++;
+static void parse_goal2(const char *token, size_t len, int *goal2) {
+  const char *p = token;
+  unsigned long value;
   int i = 0;
-  while (true) {
-    if (isdigit(*p)) {
-      goal2[i++] = strtol(p, &p, 10);
-    }
-    if (*p == '}') {
-      break;
-    }
-    p++;
+  while (next_number(&p, token + len, &value)) {
+    goal2[i++] = value;
   }
 }
 
-void parse_button1(char *token, int goal_len, unsigned long *buttons,
-                   int *buttons_len, int *buttons_capacity) {
+static void parse_button1(const char *token, size_t len, int goal_len,
+                          unsigned long *buttons, int *buttons_len,
+                          int *buttons_capacity) {
   unsigned long x = 0;
-  char *p = token;
-  while (*p) {
-    if (isdigit(*p)) {
-      x |= 1 << strtol(p, &p, 10);
-    }
-    if (*p == '(' || *p == ',') {
-      p++;
-      continue;
-    }
-    if (*p == ')') {
-      break;
-    }
+  const char *p = token;
+  unsigned long id;
+  while (next_number(&p, token + len, &id)) {
+    x |= 1 << id;
   }
   if (*buttons_len == *buttons_capacity) {
     *buttons_capacity *= 2;
@@ -59,9 +56,10 @@ void parse_button1(char *token, int goal_len, unsigned long *buttons,
   return;
 }
 
-void parse_button2(char *token, int goal_len, int (*buttons)[goal_len],
-                   int *buttons_len, int *buttons_capacity) {
-  char *p = token;
+static void parse_button2(const char *token, size_t len, int goal_len,
+                          int (*buttons)[goal_len], int *buttons_len,
+                          int *buttons_capacity) {
+  const char *p = token;
   if (buttons_len == buttons_capacity) {
     *buttons_capacity *= 2;
     buttons = realloc(buttons, *buttons_capacity * sizeof(*buttons));
@@ -70,23 +68,14 @@ void parse_button2(char *token, int goal_len, int (*buttons)[goal_len],
   for (int i = 0; i < goal_len; i++) {
     button[i] = 0;
   }
-  while (*p) {
-    if (isdigit(*p)) {
-      long id = strtol(p, &p, 10);
-      assert(id < goal_len);
-      button[id] = 1;
-    }
-    if (*p == '(' || *p == ',') {
-      p++;
-      continue;
-    }
-    if (*p == ')') {
-      return;
-    }
+  unsigned long id;
+  while (next_number(&p, token + len, &id)) {
+    assert(id < (unsigned long)goal_len);
+    button[id] = 1;
   }
 }
 
-int power(int base, int exponent) {
+static int power(int base, int exponent) {
   int result = 1;
   for (int i = 0; i < exponent; i++) {
     result *= base;
@@ -94,8 +83,8 @@ int power(int base, int exponent) {
   return result;
 }
 
-long bfs(unsigned long goal, int goal_len, unsigned long *buttons,
-         int buttons_len) {
+static long bfs(unsigned long goal, int goal_len, unsigned long *buttons,
+                int buttons_len) {
   int max = power(2, goal_len);
   long *depth = calloc(max, sizeof(long));
   bool *visited = calloc(max, sizeof(bool));
@@ -127,18 +116,23 @@ long bfs(unsigned long goal, int goal_len, unsigned long *buttons,
   }
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  char line[1024];
+void solve_10(const Input *input, Result *result) {
   long count1 = 0;
   long count2 = 0;
 
-  while (fgets(line, sizeof(line), file)) {
-
-    line[strcspn(line, "\n")] = '\0';
-    char *token = strtok(line, " ");
-    unsigned long goal1 = parse_goal1(token);
-    int goal_len = strlen(token) - 2;
+  // each machine is parsed and solved in turn, so the phases are entered
+  // once per line and add up across them
+  for (size_t j = 0; j < input->nlines; j++) {
+    PROF_PHASE("parse");
+    // tokens are read in place, each with its own length
+    const char *p = Input_line(input, j);
+    const char *end = p + Input_line_len(input, j);
+    const char *token = parse_skip_space(p, end);
+    p = parse_word(token, end);
+    assert(p);
+    size_t len = p - token;
+    unsigned long goal1 = parse_goal1(token, len);
+    int goal_len = len - 2;
 
     int buttons1_len = 0;
     int buttons1_capacity = 1024;
@@ -148,22 +142,26 @@ int main(int argc, char **argv) {
     int buttons2_capacity = 1024;
     int (*buttons2)[goal_len] = calloc(buttons2_capacity, sizeof(*buttons2));
 
-    while ((token = strtok(0, " "))) {
+    while ((p = parse_word(token = parse_skip_space(p, end), end))) {
+      len = p - token;
       if (*token == '{') {
         break;
       }
 
-      parse_button1(token, goal_len, buttons1, &buttons1_len,
+      parse_button1(token, len, goal_len, buttons1, &buttons1_len,
                     &buttons1_capacity);
-      parse_button2(token, goal_len, buttons2, &buttons2_len,
+      parse_button2(token, len, goal_len, buttons2, &buttons2_len,
                     &buttons2_capacity);
     }
+    assert(p);
 
+    PROF_PHASE("part 1");
     count1 += bfs(goal1, goal_len, buttons1, buttons1_len);
     free(buttons1);
 
+    PROF_PHASE("part 2");
     int *goal2 = malloc(sizeof(int) * goal_len);
-    parse_goal2(token, goal2);
+    parse_goal2(token, len, goal2);
 
     glp_prob *prob = glp_create_prob();
     glp_term_out(GLP_OFF);
@@ -209,9 +207,8 @@ int main(int argc, char **argv) {
     free(ja);
     free(ar);
   }
-  fclose(file);
-  printf("%ld\n", count1);
-  printf("%ld\n", count2);
+  Result_add(result, "%ld", count1);
+  Result_add(result, "%ld", count2);
+}
 
-  return 0;
-}
\ No newline at end of file
+SOLVE_MAIN(solve_10)
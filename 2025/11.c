@@ -1,72 +1,92 @@
+#include <alloc.h>
+#include <assert.h>
 #include <dict.h>
 #include <list.h>
-#include <set.h>
+#include <parse.h>
+#include <prof.h>
+#include <pset.h>
+#include <solve.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-long dfs(Dict *graph, char *start, char *end, Set *visited, Dict *record) {
+static long dfs(Dict *graph, char *start, char *end, PSet *visited,
+                Dict *record) {
   if (memcmp(start, end, sizeof(char) * 3) == 0) {
     return 1;
   }
 
-  if (Dict_find(record, start)) {
-    return *(long *)Dict_get(record, start);
+  bool found;
+  long *memo = Dict_entry(record, start, &found);
+  if (found) {
+    return *memo;
   }
 
   List *neighbours = Dict_get(graph, start);
   long sum = 0;
-  for (int i = 0; i < neighbours->len; i++) {
-    char *neighbour = List_get(neighbours, i);
-    if (Set_find(visited, neighbour)) {
+  ListItem *cursor = NULL;
+  char *neighbour;
+  while ((neighbour = List_iter_next(neighbours, &cursor))) {
+    if (PSet_find(visited, neighbour)) {
       continue;
     }
-    Set *new_visited = Set_copy(visited);
-    Set_add(new_visited, neighbour);
+    PSet *new_visited = PSet_add(visited, neighbour);
     sum += dfs(graph, neighbour, end, new_visited, record);
-    Set_free(new_visited);
+    PSet_free(new_visited);
   }
-  Dict_add(record, start, &sum);
+  *(long *)Dict_get(record, start) = sum;
   return sum;
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  char line[128];
+void solve_11(const Input *input, Result *result) {
+  PROF_PHASE("parse");
   Dict *graph =
       Dict_create(1000, sizeof(char) * 3, sizeof(List), List_copy, List_free);
+  // adjacency lists live until the end; path sets churn through the pool
+  Arena *arena = Arena_create(1 << 16);
+  Pool *pool = Pool_create(sizeof(PSetNode) + 2 * sizeof(PSetNode *), 1024);
 
-  while (fgets(line, sizeof(line), file)) {
-    char *token = strtok(line, ": ");
-    char *node = token;
-    List *neighbours = List_create(sizeof(char) * 3, 0, 0, 0);
-    while ((token = strtok(0, " \n"))) {
-      List_append(neighbours, token);
+  for (size_t j = 0; j < input->nlines; j++) {
+    // "abc: def ghi", names read in place
+    char *node = Input_line(input, j);
+    const char *end = node + Input_line_len(input, j);
+    const char *p = parse_char(node + 3, end, ':');
+    assert(p);
+    List *neighbours =
+        List_create_with(sizeof(char) * 3, 0, 0, 0, Arena_allocator(arena));
+    const char *token;
+    while ((p = parse_word(token = parse_skip_space(p, end), end))) {
+      assert(p - token == 3);
+      List_append(neighbours, (void *)token);
     }
     Dict_add(graph, node, neighbours);
     List_free(neighbours);
   }
-  List *neighbours = List_create(sizeof(char) * 3, 0, 0, 0);
+  List *neighbours =
+      List_create_with(sizeof(char) * 3, 0, 0, 0, Arena_allocator(arena));
   Dict_add(graph, "out", neighbours);
-  fclose(file);
+  List_free(neighbours);
 
-  Set *visited = Set_create(1000, sizeof(char) * 3);
+  PROF_PHASE("part 1");
+  PSet *visited = PSet_create_with(sizeof(char) * 3, Pool_allocator(pool));
   Dict *record = Dict_create(1000, sizeof(char) * 3, sizeof(long), 0, 0);
   long count1 = dfs(graph, "you", "out", visited, record);
-  Set_free(visited);
+  PSet_free(visited);
   Dict_free(record);
-  printf("%ld\n", count1);
+  Result_add(result, "%ld", count1);
 
+  PROF_PHASE("part 2");
   long count2 = 0;
 
   char start[3][3] = {"svr", "fft", "dac"};
   char end[3][3] = {"fft", "dac", "out"};
   long sum = 1;
   for (int i = 0; i < 3; i++) {
-    Set *visited = Set_create(1000, sizeof(char) * 3);
+    PSet *visited =
+        PSet_create_with(sizeof(char) * 3, Pool_allocator(pool));
     Dict *record = Dict_create(1000, sizeof(char) * 3, sizeof(long), 0, 0);
     sum *= dfs(graph, start[i], end[i], visited, record);
-    Set_free(visited);
+    PSet_free(visited);
     Dict_free(record);
   }
   count2 += sum;
@@ -78,16 +98,19 @@ int main(int argc, char **argv) {
 
   sum = 1;
   for (int i = 0; i < 3; i++) {
-    Set *visited = Set_create(1000, sizeof(char) * 3);
+    PSet *visited =
+        PSet_create_with(sizeof(char) * 3, Pool_allocator(pool));
     Dict *record = Dict_create(1000, sizeof(char) * 3, sizeof(long), 0, 0);
     sum *= dfs(graph, start[i], end[i], visited, record);
-    Set_free(visited);
+    PSet_free(visited);
     Dict_free(record);
   }
   count2 += sum;
-  printf("%ld\n", count2);
+  Result_add(result, "%ld", count2);
 
   Dict_free(graph);
+  Arena_free(arena);
+  Pool_free(pool);
+}
 
-  return 0;
-}
\ No newline at end of file
+SOLVE_MAIN(solve_11)
@@ -1,10 +1,15 @@
+#include <assert.h>
 #include <ctype.h>
+#include <parse.h>
+#include <prof.h>
+#include <solve.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-int check(char (*presents)[3][3], int presents_len, int m, int n,
-          int *num_presents) {
+static int check(char (*presents)[3][3], int presents_len, int m, int n,
+                 int *num_presents) {
   int sum1 = 0;
   for (int k = 0; k < presents_len; k++) {
     for (int i = 0; i < 3; i++) {
@@ -26,22 +31,25 @@ int check(char (*presents)[3][3], int presents_len, int m, int n,
   if (sum2 > (m / 3) * (n / 3)) {
     return 0;
   }
-  printf("too complicated :(\n");
+  fprintf(stderr, "too complicated :(\n");
   return 0;
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
+void solve_12(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  size_t line = 0;
 
   int presents_capacity = 10;
   int presents_len = 0;
   char (*presents)[3][3] = malloc(sizeof(*presents) * presents_capacity);
-  char buffer[128];
-  while (fgets(buffer, sizeof(buffer), file)) {
-    if (buffer[0] == '\n' || buffer[strlen(buffer) - 2] == ':') {
+  // lines are read in place; shapes are "k:" followed by three rows
+  for (; line < input->nlines; line++) {
+    const char *row = Input_line(input, line);
+    size_t len = Input_line_len(input, line);
+    if (len == 0 || row[len - 1] == ':') {
       continue;
     }
-    if (isdigit(buffer[0])) {
+    if (isdigit(row[0])) {
       break;
     }
 
@@ -49,32 +57,39 @@ int main(int argc, char **argv) {
       presents_capacity *= 2;
       presents = realloc(presents, sizeof(*presents) * presents_capacity);
     }
+    assert(line + 3 <= input->nlines);
     for (int i = 0; i < 3; i++) {
-      for (int j = 0; j < 3; j++) {
-        presents[presents_len][i][j] = buffer[j];
-      }
-      fgets(buffer, sizeof(buffer), file);
+      assert(Input_line_len(input, line + i) >= 3);
+      memcpy(presents[presents_len][i], Input_line(input, line + i), 3);
     }
+    line += 2;
     presents_len++;
   }
 
+  // the regions are parsed and checked one at a time
+  PROF_PHASE("solve");
   int count = 0;
-  do {
-    char *token = strtok(buffer, "x");
-    long m = strtol(token, 0, 10);
-    token = strtok(0, ": ");
-    long n = strtol(token, 0, 10);
+  for (; line < input->nlines; line++) {
+    // "MxN: c0 c1 ..."
+    const char *p = Input_line(input, line);
+    const char *end = p + Input_line_len(input, line);
+    long size[2];
+    p = parse_record(p, end, 'x', size, 2);
+    assert(p);
+    p = parse_char(p, end, ':');
+    assert(p);
     int *num_presents = malloc(sizeof(int) * presents_len);
     for (int i = 0; i < presents_len; i++) {
-      token = strtok(0, " ");
-      num_presents[i] = strtol(token, 0, 10);
+      unsigned long value;
+      p = parse_uint(parse_skip_space(p, end), end, &value);
+      assert(p);
+      num_presents[i] = value;
     }
-    count += check(presents, presents_len, m, n, num_presents);
+    count += check(presents, presents_len, size[0], size[1], num_presents);
     free(num_presents);
-
-  } while (fgets(buffer, sizeof(buffer), file));
-  printf("%d\n", count);
+  }
+  Result_add(result, "%d", count);
   free(presents);
-  fclose(file);
-  return 0;
-}
\ No newline at end of file
+}
+
+SOLVE_MAIN(solve_12)
@@ -1,26 +1,14 @@
 #include <ctype.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int capacity = 128;
-  char *buffer = malloc(capacity);
-  size_t length = 0;
-  int ch;
-  while ((ch = fgetc(file)) != EOF) {
-    if (length + 1 >= capacity) {
-      capacity *= 2;
-      buffer = realloc(buffer, capacity);
-    }
-    buffer[length++] = (char)ch;
-  }
-  buffer[length] = '\0';
-  fclose(file);
-
-  char *p = buffer;
+void solve_2(const Input *input, Result *result) {
+  PROF_PHASE("solve");
+  char *p = input->data;
   long counter1 = 0;
   long counter2 = 0;
   while (*p) {
@@ -61,8 +49,8 @@ int main(int argc, char **argv) {
       p++;
     }
   }
-  printf("%ld\n", counter1);
-  printf("%ld\n", counter2);
-  free(buffer);
-  return 0;
-}
\ No newline at end of file
+  Result_add(result, "%ld", counter1);
+  Result_add(result, "%ld", counter2);
+}
+
+SOLVE_MAIN(solve_2)
@@ -1,7 +1,10 @@
+#include <grid.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-long power(int base, int exponent) {
+static long power(int base, int exponent) {
   long result = 1;
   for (int i = 0; i < exponent; i++) {
     result *= base;
@@ -9,7 +12,7 @@ long power(int base, int exponent) {
   return result;
 }
 
-long find_combo(char *line, int nx, int digits) {
+static long find_combo(const char *line, int nx, int digits) {
   int maxes[digits];
   for (int i = 0; i < digits; i++) {
     maxes[i] = -1;
@@ -39,34 +42,20 @@ long find_combo(char *line, int nx, int digits) {
   return result;
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int ch;
-  int capacity = 128;
-  char *buffer = malloc(capacity);
-  int length = 0;
-  int nx = 0;
-  while ((ch = fgetc(file)) != EOF) {
-    if (length == capacity - 1) {
-      capacity *= 2;
-      buffer = realloc(buffer, capacity);
-    }
-    if ((char)ch == '\n' && nx == 0) {
-      nx = length;
-    }
-    buffer[length++] = ch;
-  }
-  buffer[length] = '\0';
-  int ny = length / (nx + 1);
-  const char (*lines)[nx + 1] = (void *)buffer;
+void solve_3(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  Grid *grid = Grid_from_input(input, '0');
+  // both parts scan each bank in turn
+  PROF_PHASE("solve");
   long counter1 = 0;
   long counter2 = 0;
-  for (int j = 0; j < ny; j++) {
-    counter1 += find_combo(lines[j], nx, 2);
-    counter2 += find_combo(lines[j], nx, 12);
+  for (int j = 0; j < grid->ny; j++) {
+    counter1 += find_combo(Grid_row(grid, j), grid->nx, 2);
+    counter2 += find_combo(Grid_row(grid, j), grid->nx, 12);
   }
-  printf("%ld\n", counter1);
-  printf("%ld\n", counter2);
-  free(buffer);
-  return 0;
-}
\ No newline at end of file
+  Grid_free(grid);
+  Result_add(result, "%ld", counter1);
+  Result_add(result, "%ld", counter2);
+}
+
+SOLVE_MAIN(solve_3)
@@ -1,76 +1,50 @@
-#include <list.h>
+#include <grid.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <vec.h>
 
-typedef struct {
-  int i;
-  int j;
-} Point;
-
-bool is_inside(int i, int j, int nx, int ny) {
-  return 0 <= i && i < nx && 0 <= j && j < ny;
-}
-
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int ch;
-  int capacity = 128;
-  char *buffer = malloc(capacity);
-  int length = 0;
-  int nx = 0;
-  while ((ch = fgetc(file)) != EOF) {
-    if (length == capacity - 1) {
-      capacity *= 2;
-      buffer = realloc(buffer, capacity);
-    }
-    if ((char)ch == '\n' && nx == 0) {
-      nx = length;
-    }
-    buffer[length++] = ch;
-  }
-  buffer[length] = '\0';
-  int ny = length / (nx + 1);
-  char (*lines)[nx + 1] = (void *)buffer;
+void solve_4(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  Grid *grid = Grid_from_input(input, '.');
+  PROF_PHASE("part 1");
+  int nx = grid->nx;
+  int ny = grid->ny;
 
   int global_count = 0;
   int it = 0;
   bool stop = false;
+  Vec *removed = Vec_create(nx * ny, sizeof(char *));
   while (!stop) {
-    List *removed_indexes = List_create(sizeof(Point), 0, 0, 0);
+    Vec_clear(removed);
     for (int j = 0; j < ny; j++) {
+      char *row = Grid_row(grid, j);
       for (int i = 0; i < nx; i++) {
-        if (lines[j][i] == '@') {
-          int count = 0;
-          for (int ii = i - 1; ii <= i + 1; ii++) {
-            for (int jj = j - 1; jj <= j + 1; jj++) {
-              if (is_inside(ii, jj, nx, ny)) {
-                if (lines[jj][ii] == '@') {
-                  count++;
-                }
-              }
-            }
-          }
-          if (count <= 4) {
-            List_append(removed_indexes, &(Point){i, j});
-            global_count++;
-          }
+        // the halo is '.', so border rolls need no bounds checks
+        if (row[i] == '@' && Grid_count8(grid, &row[i], '@') < 4) {
+          char *cell = &row[i];
+          Vec_push(removed, &cell);
+          global_count++;
         }
       }
     }
     if (it == 0) {
-      printf("%d\n", global_count);
+      Result_add(result, "%d", global_count);
+      PROF_PHASE("part 2");
     }
-    for (int i = 0; i < removed_indexes->len; i++) {
-      Point *p = List_get(removed_indexes, i);
-      lines[p->j][p->i] = '.';
+    for (size_t k = 0; k < removed->len; k++) {
+      **(char **)Vec_get(removed, k) = '.';
     }
-    if (removed_indexes->len == 0) {
+    if (removed->len == 0) {
       stop = true;
     }
-    List_free(removed_indexes);
     it++;
   }
-  printf("%d\n", global_count);
-  return 0;
-}
\ No newline at end of file
+  Vec_free(removed);
+  Grid_free(grid);
+  Result_add(result, "%d", global_count);
+}
+
+SOLVE_MAIN(solve_4)
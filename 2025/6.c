@@ -1,11 +1,14 @@
 #include <ctype.h>
+#include <grid.h>
 #include <list.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-long compute_result(long **array, char *operators, int rows_len,
-                    int *len_per_row, int results_len, bool row_wise) {
+static long compute_result(long **array, char *operators, int rows_len,
+                           int *len_per_row, int results_len, bool row_wise) {
   long *results = malloc(sizeof(long) * results_len);
   for (int i = 0; i < results_len; i++) {
     results[i] = (operators[i] == '+') ? 0 : 1;
@@ -41,28 +44,12 @@ long compute_result(long **array, char *operators, int rows_len,
   return counter;
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int capacity = 128;
-  char *buffer = malloc(capacity);
-  size_t length = 0;
-  int ch;
-  int nx = 0;
-  while ((ch = fgetc(file)) != EOF) {
-    if (length + 1 >= capacity) {
-      capacity *= 2;
-      buffer = realloc(buffer, capacity);
-    }
-    buffer[length++] = (char)ch;
-    if (nx == 0 && ch == '\n') {
-      nx = length - 1;
-    }
-  }
-  buffer[length] = '\0';
-  int ny = length / nx - 1;
-  fclose(file);
+void solve_6(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  // the last line holds the operators
+  int ny = input->ny - 1;
 
-  char *p = buffer;
+  char *p = input->data;
   bool stop = false;
   int rows_len = 0;
   int rows_capacity = 1024;
@@ -131,8 +118,12 @@ int main(int argc, char **argv) {
     p++;
   }
 
-  printf("%ld\n", compute_result(rows, operators, rows_len, len_per_row,
-                                 operators_len, true));
+  PROF_PHASE("part 1");
+  Result_add(result, "%ld",
+             compute_result(rows, operators, rows_len, len_per_row,
+                            operators_len, true));
+
+  PROF_PHASE("part 2");
 
   long **columns = malloc(sizeof(long *) * operators_len);
   int *len_per_column = malloc(sizeof(int) * operators_len);
@@ -143,13 +134,17 @@ int main(int argc, char **argv) {
     columns[i] = column;
   }
 
-  const char (*grid)[nx + 1] = (void *)buffer;
+  // part 2 reads the numbers top to bottom, so walk a column-major copy in
+  // which every column is contiguous; the ' ' halo ends the last column
+  Grid *grid = Grid_from_input(input, ' ');
+  Grid *transposed = Grid_transpose(grid);
+  Grid_free(grid);
   int column_id = 0;
   int i = 0;
   while (true) {
     bool new_column = true;
     for (int j = 0; j < ny; j++) {
-      if (isdigit(grid[j][i])) {
+      if (isdigit(Grid_row(transposed, i)[j])) {
         new_column = false;
       }
     }
@@ -163,7 +158,7 @@ int main(int argc, char **argv) {
     long num = 0;
     int j = 0;
     while (j < ny) {
-      char ch = grid[j][i];
+      char ch = Grid_row(transposed, i)[j];
       if (ch == ' ') {
         if (num == 0) {
           j++;
@@ -171,8 +166,8 @@ int main(int argc, char **argv) {
           break;
         }
       }
-      if (grid[j][i] != ' ') {
-        num = num * 10 + grid[j][i] - '0';
+      if (Grid_row(transposed, i)[j] != ' ') {
+        num = num * 10 + Grid_row(transposed, i)[j] - '0';
       }
       j++;
     }
@@ -185,10 +180,11 @@ int main(int argc, char **argv) {
     i++;
   }
 
-  printf("%ld\n", compute_result(columns, operators, operators_len,
-                                 len_per_column, operators_len, false));
+  Result_add(result, "%ld",
+             compute_result(columns, operators, operators_len, len_per_column,
+                            operators_len, false));
 
-  free(buffer);
+  Grid_free(transposed);
   for (int i = 0; i < rows_len; i++) {
     free(rows[i]);
   }
@@ -198,5 +194,6 @@ int main(int argc, char **argv) {
   }
   free(columns);
   free(operators);
-  return 0;
-}
\ No newline at end of file
+}
+
+SOLVE_MAIN(solve_6)
@@ -1,103 +1,72 @@
+#include <bitset.h>
 #include <dict.h>
-#include <set.h>
+#include <grid.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-typedef struct {
-  int i;
-  int j;
-} Coordinate;
+// Padding around the manifold. Beams stop when they step onto it, so the
+// walks below never check coordinates.
+#define HALO ' '
 
-void count_splits(int i, int j, int nx, int ny, const char (*grid)[nx + 1],
-                  int *counter, Set *visited) {
-  Set_add(visited, &(Coordinate){i, j});
-  if (grid[j][i] == '^') {
-    (*counter)++;
-    if (i - 1 >= 0 && !Set_find(visited, &(Coordinate){i - 1, j})) {
-      count_splits(i - 1, j, nx, ny, grid, counter, visited);
-    }
-    if (i + 1 < nx && !Set_find(visited, &(Coordinate){i + 1, j})) {
-      count_splits(i + 1, j, nx, ny, grid, counter, visited);
-    }
+static void count_splits(const Grid *grid, const char *cell, int *counter,
+                         BitSet *visited) {
+  if (*cell == HALO || BitSet_test_and_add(visited, cell - grid->cells)) {
     return;
+  }
+  if (*cell == '^') {
+    (*counter)++;
+    count_splits(grid, cell - 1, counter, visited);
+    count_splits(grid, cell + 1, counter, visited);
   } else {
-    if (j == ny - 1) {
-      return;
-    } else {
-      if (!Set_find(visited, &(Coordinate){i, j + 1})) {
-        count_splits(i, j + 1, nx, ny, grid, counter, visited);
-      }
-      return;
-    }
+    count_splits(grid, cell + grid->stride, counter, visited);
   }
 }
 
-long count_timelines(int i, int j, int nx, int ny, const char (*grid)[nx + 1],
-                     Dict *record) {
-  if (Dict_find(record, &(Coordinate){i, j})) {
-    return *(long *)Dict_get(record, &(Coordinate){i, j});
+static long count_timelines(const Grid *grid, const char *cell, Dict *record) {
+  if (*cell == HALO) {
+    // leaving through the bottom ends one timeline, through a side none
+    return cell >= Grid_row(grid, grid->ny) ? 1 : 0;
+  }
+  long offset = cell - grid->cells;
+  bool found;
+  long *memo = Dict_entry(record, &offset, &found);
+  if (found) {
+    return *memo;
   }
-  if (grid[j][i] == '^') {
-    long sum = 0;
-    if (i - 1 >= 0) {
-      sum += count_timelines(i - 1, j, nx, ny, grid, record);
-    }
-    if (i + 1 < nx) {
-      sum += count_timelines(i + 1, j, nx, ny, grid, record);
-    }
-    Dict_add(record, &(Coordinate){i, j}, &sum);
-    return sum;
+  long result = 0;
+  if (*cell == '^') {
+    result += count_timelines(grid, cell - 1, record);
+    result += count_timelines(grid, cell + 1, record);
   } else {
-    if (j == ny - 1) {
-      return 1;
-    }
-    long result = count_timelines(i, j + 1, nx, ny, grid, record);
-    Dict_add(record, &(Coordinate){i, j}, &result);
-    return result;
+    result = count_timelines(grid, cell + grid->stride, record);
   }
+  // the recursion may have grown the table, so fetch the slot again
+  *(long *)Dict_get(record, &offset) = result;
+  return result;
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int capacity = 128;
-  char *buffer = malloc(capacity);
-  size_t length = 0;
-  int ch;
-  int nx = 0;
-  int start = 0;
-  while ((ch = fgetc(file)) != EOF) {
-    if (length + 1 >= capacity) {
-      capacity *= 2;
-      buffer = realloc(buffer, capacity);
-    }
-    if (nx == 0 && ch == '\n') {
-      nx = length;
-    }
-    if (ch == 'S') {
-      start = length;
-    }
-    buffer[length++] = (char)ch;
-  }
-  buffer[length] = '\0';
-  fclose(file);
-
-  int ny = length / (nx + 1);
-  char (*grid)[nx + 1] = (void *)buffer;
-  int is = start % (nx + 1);
-  int js = (start) / (nx + 1);
+void solve_7(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  Grid *grid = Grid_from_input(input, HALO);
+  size_t ncells = (size_t)grid->stride * (grid->ny + 2);
+  const char *start = memchr(grid->cells, 'S', ncells);
 
+  PROF_PHASE("part 1");
   int counter1 = 0;
-  Set *visited = Set_create(nx * ny * 2, sizeof(Coordinate));
-  count_splits(is, js, nx, ny, grid, &counter1, visited);
-  printf("%d\n", counter1);
+  BitSet *visited = BitSet_create(ncells);
+  count_splits(grid, start, &counter1, visited);
+  Result_add(result, "%d", counter1);
 
-  Dict *record =
-      Dict_create(nx * ny * 2, sizeof(Coordinate), sizeof(long), 0, 0);
-  long counter2 = count_timelines(is, js, nx, ny, grid, record);
-  printf("%ld\n", counter2);
+  PROF_PHASE("part 2");
+  Dict *record = Dict_create(ncells * 2, sizeof(long), sizeof(long), 0, 0);
+  long counter2 = count_timelines(grid, start, record);
+  Result_add(result, "%ld", counter2);
 
-  free(buffer);
-  Set_free(visited);
+  Grid_free(grid);
+  BitSet_free(visited);
   Dict_free(record);
-  return 0;
-}
\ No newline at end of file
+}
+
+SOLVE_MAIN(solve_7)
@@ -1,9 +1,13 @@
+#include <alloc.h>
 #include <dict.h>
 #include <heap.h>
-#include <list.h>
+#include <parse.h>
+#include <prof.h>
 #include <set.h>
+#include <solve.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <vec.h>
 
 typedef struct {
   long x;
@@ -16,28 +20,14 @@ typedef struct {
   Coordinate b;
 } Pair;
 
-long distance(Pair pair) {
+static long distance(Pair pair) {
   Coordinate p1 = pair.a;
   Coordinate p2 = pair.b;
   return (p1.x - p2.x) * (p1.x - p2.x) + (p1.y - p2.y) * (p1.y - p2.y) +
          (p1.z - p2.z) * (p1.z - p2.z);
 }
 
-int compare_distance(const void *p1, const void *p2) {
-  Pair pair1 = *(const Pair *)p1;
-  Pair pair2 = *(const Pair *)p2;
-  long d1 = distance(pair1);
-  long d2 = distance(pair2);
-  if (d1 > d2) {
-    return 1;
-  }
-  if (d1 < d2) {
-    return -1;
-  }
-  return 0;
-}
-
-int compare_descend(const void *d1, const void *d2) {
+static int compare_descend(const void *d1, const void *d2) {
   long a = *(const long *)d1;
   long b = *(const long *)d2;
   if (a > b) {
@@ -49,23 +39,21 @@ int compare_descend(const void *d1, const void *d2) {
   return 0;
 }
 
-void add_to_graph(Dict *graph, Coordinate a, Coordinate b) {
-  if (Dict_find(graph, &a)) {
-    List *neighbours = Dict_get(graph, &a);
-    List_append(neighbours, &b);
-  } else {
-    List *neighbours = List_create(sizeof(Coordinate), 0, 0, 0);
-    List_append(neighbours, &b);
-    Dict_add(graph, &a, neighbours);
+static void add_to_graph(Dict *graph, Coordinate a, Coordinate b) {
+  bool found;
+  Vec **neighbours = Dict_entry(graph, &a, &found);
+  if (!found) {
+    *neighbours = Vec_create(0, sizeof(Coordinate));
   }
+  Vec_push(*neighbours, &b);
 }
 
-long dfs(Coordinate *p, Dict *graph, Set *visited) {
+static long dfs(Coordinate *p, Dict *graph, Set *visited) {
   Set_add(visited, p);
   long count = 1;
-  List *neighbours = Dict_get(graph, p);
-  for (int i = 0; i < neighbours->len; i++) {
-    Coordinate *neighbour = List_get(neighbours, i);
+  Vec *neighbours = Dict_get(graph, p);
+  for (size_t i = 0; i < neighbours->len; i++) {
+    Coordinate *neighbour = Vec_get(neighbours, i);
     if (!Set_find(visited, neighbour)) {
       count += dfs(neighbour, graph, visited);
     }
@@ -73,67 +61,77 @@ long dfs(Coordinate *p, Dict *graph, Set *visited) {
   return count;
 }
 
-void find_circuits(Dict *graph, long *circuit_sizes) {
-  Coordinate **coordinates = Dict_keys(graph);
-  Set *visited = Set_create(100000, sizeof(Coordinate));
+static void find_circuits(Dict *graph, long *circuit_sizes, Arena *arena) {
+  Set *visited =
+      Set_create_with(100000, sizeof(Coordinate), Arena_allocator(arena));
   int circuit_sizes_len = 0;
-  for (int i = 0; i < graph->len; i++) {
-    if (!Set_find(visited, coordinates[i])) {
-      circuit_sizes[circuit_sizes_len++] = dfs(coordinates[i], graph, visited);
+  size_t cursor = 0;
+  DictItem item;
+  while (Dict_iter_next(graph, &cursor, &item)) {
+    if (!Set_find(visited, item.key)) {
+      circuit_sizes[circuit_sizes_len++] = dfs(item.key, graph, visited);
     }
   }
-  free(coordinates);
   Set_free(visited);
+  Arena_reset(arena);
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
-  int coordinates_capacity = 1024;
-  int coordinates_len = 0;
-  Coordinate *coordinates = malloc(sizeof(Coordinate) * coordinates_capacity);
+void solve_8(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  const char *p = input->data;
+  const char *end = input->data + input->len;
+  Vec *coordinates_vec = Vec_create(1024, sizeof(Coordinate));
 
-  long a, b, c;
-  while (fscanf(file, "%ld,%ld,%ld\n", &a, &b, &c) == 3) {
-    if (coordinates_len == coordinates_capacity) {
-      coordinates_capacity *= 2;
-      coordinates = realloc(coordinates, coordinates_capacity);
-    }
-    coordinates[coordinates_len++] = (Coordinate){a, b, c};
+  long xyz[3];
+  while ((p = parse_record(p, end, ',', xyz, 3))) {
+    Vec_push(coordinates_vec, &(Coordinate){xyz[0], xyz[1], xyz[2]});
   }
+  int coordinates_len = coordinates_vec->len;
+  Coordinate *coordinates = (Coordinate *)coordinates_vec->data;
 
+  // Pairs come out nearest first. Building the heap is O(n) and only the
+  // pairs consumed before the circuit closes are ever ordered, instead of
+  // sorting all of them up front.
+  PROF_PHASE("pairs");
   int n_pairs = coordinates_len * (coordinates_len - 1) / 2;
-  Pair *pairs = malloc(sizeof(Pair) * n_pairs);
-  int pairs_len = 0;
+  Heap *pairs = Heap_create_priority(n_pairs, sizeof(Pair), 0);
   for (int i = 0; i < coordinates_len; i++) {
     for (int j = i + 1; j < coordinates_len; j++) {
       Pair pair = {coordinates[i], coordinates[j]};
-      pairs[pairs_len++] = pair;
+      Heap_append_priority(pairs, -distance(pair), &pair, NULL);
     }
   }
+  Heap_build(pairs);
 
-  qsort(pairs, n_pairs, sizeof(Pair), compare_distance);
-
+  // part 1 is answered along the way, after the first 1000 pairs
+  PROF_PHASE("circuits");
   Dict *graph = Dict_create(coordinates_len * 2, sizeof(Coordinate),
-                            sizeof(List), List_copy, List_free);
-  for (int i = 0; i < n_pairs; i++) {
-    Pair pair = pairs[i];
+                            sizeof(Vec), Vec_copy, Vec_free);
+  Arena *arena = Arena_create(sizeof(Coordinate) * 4096);
+  for (int i = 0; pairs->len; i++) {
+    Pair pair;
+    Heap_pop(pairs, &pair, NULL);
     add_to_graph(graph, pair.a, pair.b);
     add_to_graph(graph, pair.b, pair.a);
     long *circuit_sizes = calloc(graph->len, sizeof(long));
-    find_circuits(graph, circuit_sizes);
-    qsort(circuit_sizes, graph->len, sizeof(long), compare_descend);
+    find_circuits(graph, circuit_sizes, arena);
+    long largest[3] = {0};
+    Heap_select(circuit_sizes, graph->len, sizeof(long), 3, compare_descend,
+                largest);
     if (i == 999) {
-      printf("%ld\n", circuit_sizes[0] * circuit_sizes[1] * circuit_sizes[2]);
+      Result_add(result, "%ld", largest[0] * largest[1] * largest[2]);
     }
-    if (circuit_sizes[0] == coordinates_len) {
-      printf("%ld\n", pair.a.x * pair.b.x);
+    if (largest[0] == coordinates_len) {
+      Result_add(result, "%ld", pair.a.x * pair.b.x);
       free(circuit_sizes);
       break;
     }
     free(circuit_sizes);
   }
-  free(pairs);
-  free(coordinates);
+  Heap_free(pairs);
+  Vec_free(coordinates_vec);
   Dict_free(graph);
-  return 0;
-}
\ No newline at end of file
+  Arena_free(arena);
+}
+
+SOLVE_MAIN(solve_8)
@@ -1,4 +1,7 @@
 #include <assert.h>
+#include <parse.h>
+#include <prof.h>
+#include <solve.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,11 +18,11 @@ typedef struct {
 
 typedef enum { HORIZONTAL, VERTICAL } ORIENTATION;
 
-long distance(Pair pair) {
+static long distance(Pair pair) {
   return (labs(pair.a.x - pair.b.x) + 1) * (labs(pair.a.y - pair.b.y) + 1);
 }
 
-int compare_distance(const void *p1, const void *p2) {
+static int compare_distance(const void *p1, const void *p2) {
   Pair pair1 = *(const Pair *)p1;
   Pair pair2 = *(const Pair *)p2;
   long d1 = distance(pair1);
@@ -33,7 +36,7 @@ int compare_distance(const void *p1, const void *p2) {
   return 0;
 }
 
-ORIENTATION orientation(const Pair *edge) {
+static ORIENTATION orientation(const Pair *edge) {
   if (edge->a.y == edge->b.y) {
     return HORIZONTAL;
   }
@@ -41,7 +44,7 @@ ORIENTATION orientation(const Pair *edge) {
   return VERTICAL;
 }
 
-bool intersects(const Pair *edge1, const Pair *edge2) {
+static bool intersects(const Pair *edge1, const Pair *edge2) {
   if (orientation(edge1) == orientation(edge2)) {
     return false;
   }
@@ -53,7 +56,7 @@ bool intersects(const Pair *edge1, const Pair *edge2) {
   }
 }
 
-bool on_edge(const Coordinate *point, const Pair *edge) {
+static bool on_edge(const Coordinate *point, const Pair *edge) {
   if (orientation(edge) == HORIZONTAL) {
     return point->y == edge->a.y && point->x >= edge->a.x &&
            point->x <= edge->b.x;
@@ -63,8 +66,8 @@ bool on_edge(const Coordinate *point, const Pair *edge) {
   }
 }
 
-bool ray_casting(const Coordinate *point, const Pair *domain_edges,
-                 int domain_edges_len) {
+static bool ray_casting(const Coordinate *point, const Pair *domain_edges,
+                        int domain_edges_len) {
   for (int i = 0; i < domain_edges_len; i++) {
     if (on_edge(point, &domain_edges[i])) {
       return true;
@@ -83,7 +86,7 @@ bool ray_casting(const Coordinate *point, const Pair *domain_edges,
   return count % 2;
 }
 
-Pair make_pair(Coordinate a, Coordinate b) {
+static Pair make_pair(Coordinate a, Coordinate b) {
   if (a.x == b.x) {
     return a.y < b.y ? (Pair){a, b} : (Pair){b, a};
   } else {
@@ -91,21 +94,23 @@ Pair make_pair(Coordinate a, Coordinate b) {
   }
 }
 
-int main(int argc, char **argv) {
-  FILE *file = fopen(argv[1], "r");
+void solve_9(const Input *input, Result *result) {
+  PROF_PHASE("parse");
+  const char *p = input->data;
+  const char *end = input->data + input->len;
   int vertices_len = 0;
   int vertices_capacity = 1024;
   Coordinate *vertices = malloc(sizeof(Coordinate) * vertices_capacity);
-  long a, b;
-  while (fscanf(file, "%ld,%ld\n", &a, &b) == 2) {
+  long xy[2];
+  while ((p = parse_record(p, end, ',', xy, 2))) {
     if (vertices_len == vertices_capacity) {
       vertices_capacity *= 2;
       vertices = realloc(vertices, sizeof(Coordinate) * vertices_capacity);
     }
-    vertices[vertices_len++] = (Coordinate){a, b};
+    vertices[vertices_len++] = (Coordinate){xy[0], xy[1]};
   }
-  fclose(file);
 
+  PROF_PHASE("part 1");
   int pairs_capacity = vertices_len * (vertices_len - 1) / 2;
   int pairs_len = 0;
   Pair *pairs = malloc(sizeof(Pair) * pairs_capacity);
@@ -115,8 +120,9 @@ int main(int argc, char **argv) {
     }
   }
   qsort(pairs, pairs_len, sizeof(Pair), compare_distance);
-  printf("%ld\n", distance(pairs[0]));
+  Result_add(result, "%ld", distance(pairs[0]));
 
+  PROF_PHASE("part 2");
   Pair *domain_edges = malloc(sizeof(Pair) * vertices_len);
   int domain_edges_len = 0;
   for (int i = 0; i < vertices_len; i++) {
@@ -154,7 +160,7 @@ int main(int argc, char **argv) {
         }
       }
       if (corners_all_inside) {
-        printf("%ld\n", distance(pairs[i]));
+        Result_add(result, "%ld", distance(pairs[i]));
         break;
       }
     }
@@ -163,5 +169,6 @@ int main(int argc, char **argv) {
   free(domain_edges);
   free(vertices);
   free(pairs);
-  return 0;
-}
\ No newline at end of file
+}
+
+SOLVE_MAIN(solve_9)
@@ -0,0 +1,184 @@
+#include <pthread.h>
+#include <solve.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Runs any subset of the days in one process, one after another or on a
+// pool of threads, and prints the answers with load and solve times.
+//
+// usage: aoc [-j THREADS] [--inputs DIR] [DAY | DAY:PATH]...
+//
+// Without days all of them run. A day without a path reads DIR/N.txt or
+// DIR/N (DIR defaults to inputs). -j 0 uses one thread per CPU; the
+// default, -j 1, runs the days sequentially on the main thread. Built with
+// -DPROF the report of every day follows the table.
+
+void solve_1(const Input *input, Result *result);
+void solve_2(const Input *input, Result *result);
+void solve_3(const Input *input, Result *result);
+void solve_4(const Input *input, Result *result);
+void solve_5(const Input *input, Result *result);
+void solve_6(const Input *input, Result *result);
+void solve_7(const Input *input, Result *result);
+void solve_8(const Input *input, Result *result);
+void solve_9(const Input *input, Result *result);
+void solve_10(const Input *input, Result *result);
+void solve_11(const Input *input, Result *result);
+void solve_12(const Input *input, Result *result);
+
+const Solver solvers[] = {NULL,     solve_1,  solve_2, solve_3, solve_4,
+                          solve_5,  solve_6,  solve_7, solve_8, solve_9,
+                          solve_10, solve_11, solve_12};
+#define NDAYS 12
+
+typedef struct {
+  int day;
+  char path[4096];
+  Result result;
+  double load;
+  double solve;
+#ifdef PROF
+  char *report;
+#endif
+} Job;
+
+typedef struct {
+  Job *jobs;
+  int njobs;
+  atomic_int next;
+} Queue;
+
+void run_job(Job *job) {
+  double t0 = solve_clock();
+  PROF_PHASE("read");
+  Input *input = Input_open(job->path);
+  PROF_PHASE_END();
+  double t1 = solve_clock();
+  Result_init(&job->result, NULL);
+  solvers[job->day](input, &job->result);
+  PROF_PHASE_END();
+  double t2 = solve_clock();
+  Input_free(input);
+  job->load = t1 - t0;
+  job->solve = t2 - t1;
+#ifdef PROF
+  // the state is per thread, so this holds only what the job recorded
+  size_t size;
+  FILE *report = open_memstream(&job->report, &size);
+  PROF_REPORT(report);
+  fclose(report);
+#endif
+}
+
+void *worker(void *arg) {
+  Queue *queue = arg;
+  int i;
+  while ((i = atomic_fetch_add(&queue->next, 1)) < queue->njobs) {
+    run_job(&queue->jobs[i]);
+  }
+  return NULL;
+}
+
+// Picks the input of `day` in `dir`, or returns false if there is none.
+bool find_input(const char *dir, int day, char *path, size_t size) {
+  snprintf(path, size, "%s/%d.txt", dir, day);
+  if (access(path, R_OK) == 0) {
+    return true;
+  }
+  snprintf(path, size, "%s/%d", dir, day);
+  return access(path, R_OK) == 0;
+}
+
+void usage(void) {
+  fprintf(stderr,
+          "usage: aoc [-j THREADS] [--inputs DIR] [DAY | DAY:PATH]...\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+  int threads = 1;
+  const char *dir = "inputs";
+  Job *jobs = calloc(argc + NDAYS, sizeof(Job));
+  int njobs = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--inputs") == 0 && i + 1 < argc) {
+      dir = argv[++i];
+    } else {
+      char *end;
+      long day = strtol(argv[i], &end, 10);
+      if (end == argv[i] || day < 1 || day > NDAYS ||
+          (*end && *end != ':')) {
+        usage();
+      }
+      Job *job = &jobs[njobs++];
+      job->day = day;
+      // an empty path means the default one
+      snprintf(job->path, sizeof(job->path), "%s", *end ? end + 1 : "");
+    }
+  }
+  if (njobs == 0) {
+    for (int day = 1; day <= NDAYS; day++) {
+      jobs[njobs++].day = day;
+    }
+  }
+  for (int i = 0; i < njobs; i++) {
+    Job *job = &jobs[i];
+    if (!job->path[0] &&
+        !find_input(dir, job->day, job->path, sizeof(job->path))) {
+      fprintf(stderr, "day %d: no input %s/%d.txt or %s/%d\n", job->day, dir,
+              job->day, dir, job->day);
+      return EXIT_FAILURE;
+    }
+  }
+  if (threads <= 0) {
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (threads > njobs) {
+    threads = njobs;
+  }
+
+  Queue queue = {jobs, njobs, 0};
+  double start = solve_clock();
+  if (threads <= 1) {
+    worker(&queue);
+  } else {
+    pthread_t *pool = malloc(threads * sizeof(pthread_t));
+    for (int t = 0; t < threads; t++) {
+      pthread_create(&pool[t], NULL, worker, &queue);
+    }
+    for (int t = 0; t < threads; t++) {
+      pthread_join(pool[t], NULL);
+    }
+    free(pool);
+  }
+  double wall = solve_clock() - start;
+
+  printf("%3s  %-20s %-20s %9s %9s\n", "day", "part 1", "part 2", "load ms",
+         "solve ms");
+  double cpu = 0;
+  for (int i = 0; i < njobs; i++) {
+    Job *job = &jobs[i];
+    Result *result = &job->result;
+    printf("%3d  %-20s %-20s %9.3f %9.3f\n", job->day,
+           result->nparts > 0 ? result->parts[0] : "",
+           result->nparts > 1 ? result->parts[1] : "", job->load * 1e3,
+           job->solve * 1e3);
+    cpu += job->load + job->solve;
+  }
+  printf("%d days in %.3f ms wall, %.3f ms summed, %d thread%s\n", njobs,
+         wall * 1e3, cpu * 1e3, threads, threads == 1 ? "" : "s");
+#ifdef PROF
+  for (int i = 0; i < njobs; i++) {
+    printf("\nday %d\n%s", jobs[i].day, jobs[i].report);
+    free(jobs[i].report);
+  }
+#endif
+  free(jobs);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#include <alloc.h>
+#include <dict.h>
+#include <set.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Insert/remove churn on Dict and Set: keeps `live` keys resident while
+// streaming new keys in and the oldest keys out, and samples the probe
+// lengths of the live keys every round. With backward-shift deletion the
+// averages stay flat no matter how many keys have passed through.
+// A second pass repeats the Set churn with its items coming from counted
+// malloc, an Arena and a Pool, and reports each allocator's traffic.
+
+typedef struct {
+  long x;
+  long y;
+} Coordinate;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+Coordinate key_of(size_t k) { return (Coordinate){k % 1000, k / 1000}; }
+
+// Displacement + 1 of every live entry from its home slot.
+void dict_probe_lengths(const Dict *dict, double *avg, size_t *max) {
+  size_t total = 0;
+  *max = 0;
+  const DictTable *table = &dict->table;
+  for (size_t i = 0; i < table->capacity; i++) {
+    if (ctrl_full(table->ctrl[i])) {
+      size_t mask = table->capacity - 1;
+      size_t home = Dict_hash(dict, Dict_key_at(dict, table, i)) & mask;
+      size_t steps = ((i - home) & mask) + 1;
+      total += steps;
+      *max = steps > *max ? steps : *max;
+    }
+  }
+  *avg = (double)total / dict->len;
+}
+
+void set_probe_lengths(const Set *set, double *avg, size_t *max) {
+  size_t total = 0;
+  *max = 0;
+  for (size_t i = 0; i < set->capacity; i++) {
+    if (ctrl_full(set->ctrl[i])) {
+      size_t home = Set_index(set, set->table[i]);
+      size_t steps = ((i - home) & (set->capacity - 1)) + 1;
+      total += steps;
+      *max = steps > *max ? steps : *max;
+    }
+  }
+  *avg = (double)total / set->len;
+}
+
+// One Set churn of `rounds` rounds over `live` keys with items from
+// `allocator`; returns the churned keys per second.
+double set_churn_with(Allocator *allocator, size_t live, int rounds) {
+  Set *set = Set_create_with(live * 2, sizeof(Coordinate), allocator);
+  for (size_t k = 0; k < live; k++) {
+    Coordinate key = key_of(k);
+    Set_add(set, &key);
+  }
+  double t0 = now();
+  for (size_t k = 0; k < live * rounds; k++) {
+    Coordinate add = key_of(live + k);
+    Coordinate del = key_of(k);
+    Set_add(set, &add);
+    Set_remove(set, &del);
+  }
+  double t1 = now();
+  Set_free(set);
+  return 2 * live * rounds / (t1 - t0);
+}
+
+int main(int argc, char **argv) {
+  size_t live = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 10;
+
+  Dict *dict = Dict_create(live * 2, sizeof(Coordinate), sizeof(long), 0, 0);
+  Set *set = Set_create(live * 2, sizeof(Coordinate));
+  for (size_t k = 0; k < live; k++) {
+    Coordinate key = key_of(k);
+    long value = k;
+    Dict_add(dict, &key, &value);
+    Set_add(set, &key);
+  }
+
+  printf("%6s %12s %9s %9s %9s %9s %9s %9s\n", "round", "churned",
+         "dict avg", "dict max", "dict M/s", "set avg", "set max", "set M/s");
+  size_t oldest = 0;
+  size_t next = live;
+  for (int round = 0; round <= rounds; round++) {
+    double dict_avg, set_avg;
+    size_t dict_max, set_max;
+    dict_probe_lengths(dict, &dict_avg, &dict_max);
+    set_probe_lengths(set, &set_avg, &set_max);
+
+    double t0 = now();
+    for (size_t k = 0; k < live; k++) {
+      Coordinate add = key_of(next + k);
+      Coordinate del = key_of(oldest + k);
+      long value = next + k;
+      Dict_add(dict, &add, &value);
+      Dict_remove(dict, &del);
+    }
+    double t1 = now();
+    for (size_t k = 0; k < live; k++) {
+      Coordinate add = key_of(next + k);
+      Coordinate del = key_of(oldest + k);
+      Set_add(set, &add);
+      Set_remove(set, &del);
+    }
+    double t2 = now();
+    oldest += live;
+    next += live;
+
+    printf("%6d %12zu %9.2f %9zu %9.1f %9.2f %9zu %9.1f\n", round,
+           round * live, dict_avg, dict_max, 2 * live / (t1 - t0) * 1e-6,
+           set_avg, set_max, 2 * live / (t2 - t1) * 1e-6);
+  }
+
+  Dict_free(dict);
+  Set_free(set);
+
+  Allocator heap = Allocator_malloc();
+  Arena *arena = Arena_create(4096 * sizeof(Coordinate));
+  Pool *pool = Pool_create(sizeof(Coordinate), 4096);
+  const char *names[] = {"malloc", "arena", "pool"};
+  Allocator *allocators[] = {&heap, Arena_allocator(arena),
+                             Pool_allocator(pool)};
+  printf("\n%-8s %9s\n", "alloc", "set M/s");
+  for (int a = 0; a < 3; a++) {
+    double rate = set_churn_with(allocators[a], live, rounds);
+    printf("%-8s %9.1f\n", names[a], rate * 1e-6);
+    fflush(stdout);
+    Allocator_report(allocators[a], names[a]);
+  }
+  Arena_free(arena);
+  Pool_free(pool);
+  return 0;
+}
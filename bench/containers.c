@@ -0,0 +1,468 @@
+#include <dict.h>
+#include <heap.h>
+#include <list.h>
+#include <set.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Microbenchmark of the generic containers: Dict (key -> long), Set and
+// List get insert, lookup hit and miss, delete churn, iteration and copy;
+// Heap (integer priority, the key as payload) gets push and pop. Every
+// operation runs at each size and key size and reports ns/op and Mops/s.
+//
+// usage: bench_containers.exe [--sizes 100,1000,...] [--keys 3,8,16,24]
+//                             [--containers dict,set,heap,list]
+//                             [--min-ops N]
+//
+// Sizes default to 1e2 through 1e7. Small sizes repeat until at least
+// --min-ops (default 1e6) operations were timed. Keys are derived from
+// their index by a bijective mix, so they are distinct, scattered and
+// cheap to rebuild inside the timed loops (that cost is included). With
+// 3-byte keys the key space is 2^24, which caps the misses and churn.
+// Insert starts from an empty container, so it includes growth; copy and
+// iteration count one op per element. List lookups are linear scans and
+// are limited to LIST_SCAN_BUDGET compared elements.
+
+#define MAX_KEY 24
+#define LIST_SCAN_BUDGET 100000000ULL
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// Writes key `i` of `size` bytes. Distinct indices give distinct keys
+// while i < 2^(8 * size): narrow keys multiply by an odd constant modulo
+// their width, wider ones start with mix(i) and pad with more mixing.
+void key_of(uint64_t i, size_t size, unsigned char *key) {
+  if (size < sizeof(uint64_t)) {
+    uint64_t x = i * 0x9E3779B97F4A7C15ULL;
+    x &= (1ULL << (8 * size)) - 1;
+    memcpy(key, &x, size);
+    return;
+  }
+  uint64_t x = mix(i);
+  memcpy(key, &x, sizeof(x));
+  for (size_t offset = sizeof(x); offset < size; offset += sizeof(x)) {
+    uint64_t pad = mix(x + offset);
+    size_t len = size - offset < sizeof(pad) ? size - offset : sizeof(pad);
+    memcpy(key + offset, &pad, len);
+  }
+}
+
+// Number of distinct keys of `size` bytes, saturated.
+uint64_t key_space(size_t size) {
+  return size < sizeof(uint64_t) ? 1ULL << (8 * size) : UINT64_MAX;
+}
+
+typedef struct {
+  size_t keySize;
+  size_t n;
+  // repetitions that make up at least --min-ops operations
+  size_t rounds;
+  // how many indices from n on still give new keys
+  uint64_t spare;
+} Config;
+
+void report(const char *container, const char *op, const Config *config,
+            size_t ops, double seconds) {
+  printf("%-5s %-8s %4zu %10zu %12zu %12.2f %10.2f\n", container, op,
+         config->keySize, config->n, ops, seconds / ops * 1e9,
+         ops / seconds * 1e-6);
+}
+
+// Aborts the run when a container returned a wrong answer.
+void check(bool ok, const char *container, const char *op) {
+  if (!ok) {
+    fprintf(stderr, "%s %s: wrong result\n", container, op);
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Key of the j-th lookup miss.
+uint64_t miss_index(const Config *config, size_t j) {
+  return config->n + j % config->spare;
+}
+
+void bench_dict(const Config *config) {
+  size_t n = config->n;
+  unsigned char key[MAX_KEY];
+  Dict *dict = NULL;
+  double t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    if (dict) {
+      Dict_free(dict);
+    }
+    double t0 = now();
+    dict = Dict_create(16, config->keySize, sizeof(long), 0, 0);
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      long value = i;
+      Dict_add(dict, key, &value);
+    }
+    t += now() - t0;
+  }
+  check(dict->len == n, "dict", "insert");
+  report("dict", "insert", config, n * config->rounds, t);
+
+  size_t found = 0;
+  double t0 = now();
+  for (size_t r = 0; r < config->rounds; r++) {
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      long *value = Dict_get(dict, key);
+      found += value && *value == (long)i;
+    }
+  }
+  report("dict", "hit", config, n * config->rounds, now() - t0);
+  check(found == n * config->rounds, "dict", "hit");
+
+  found = 0;
+  t0 = now();
+  for (size_t j = 0; j < n * config->rounds; j++) {
+    key_of(miss_index(config, j), config->keySize, key);
+    found += Dict_find(dict, key);
+  }
+  report("dict", "miss", config, n * config->rounds, now() - t0);
+  check(found == 0, "dict", "miss");
+
+  long sum = 0;
+  t0 = now();
+  for (size_t r = 0; r < config->rounds; r++) {
+    size_t cursor = 0;
+    DictItem item;
+    while (Dict_iter_next(dict, &cursor, &item)) {
+      sum += *(long *)item.value;
+    }
+  }
+  report("dict", "iterate", config, n * config->rounds, now() - t0);
+  check(sum == (long)(n * (n - 1) / 2 * config->rounds), "dict", "iterate");
+
+  t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    t0 = now();
+    Dict *copy = Dict_copy(dict);
+    t += now() - t0;
+    check(copy->len == n, "dict", "copy");
+    Dict_free(copy);
+  }
+  report("dict", "copy", config, n * config->rounds, t);
+
+  // remove the oldest key, add a new one; the size stays at n
+  size_t churn = n * config->rounds;
+  if (churn > config->spare) {
+    churn = config->spare;
+  }
+  t0 = now();
+  for (size_t j = 0; j < churn; j++) {
+    key_of(j, config->keySize, key);
+    Dict_remove(dict, key);
+    key_of(n + j, config->keySize, key);
+    long value = n + j;
+    Dict_add(dict, key, &value);
+  }
+  report("dict", "churn", config, 2 * churn, now() - t0);
+  check(dict->len == n, "dict", "churn");
+  Dict_free(dict);
+}
+
+void bench_set(const Config *config) {
+  size_t n = config->n;
+  unsigned char key[MAX_KEY];
+  Set *set = NULL;
+  double t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    if (set) {
+      Set_free(set);
+    }
+    double t0 = now();
+    set = Set_create(16, config->keySize);
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      Set_add(set, key);
+    }
+    t += now() - t0;
+  }
+  check(set->len == n, "set", "insert");
+  report("set", "insert", config, n * config->rounds, t);
+
+  size_t found = 0;
+  double t0 = now();
+  for (size_t r = 0; r < config->rounds; r++) {
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      found += Set_find(set, key);
+    }
+  }
+  report("set", "hit", config, n * config->rounds, now() - t0);
+  check(found == n * config->rounds, "set", "hit");
+
+  found = 0;
+  t0 = now();
+  for (size_t j = 0; j < n * config->rounds; j++) {
+    key_of(miss_index(config, j), config->keySize, key);
+    found += Set_find(set, key);
+  }
+  report("set", "miss", config, n * config->rounds, now() - t0);
+  check(found == 0, "set", "miss");
+
+  size_t count = 0;
+  t0 = now();
+  for (size_t r = 0; r < config->rounds; r++) {
+    size_t cursor = 0;
+    while (Set_iter_next(set, &cursor)) {
+      count++;
+    }
+  }
+  report("set", "iterate", config, n * config->rounds, now() - t0);
+  check(count == n * config->rounds, "set", "iterate");
+
+  t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    t0 = now();
+    Set *copy = Set_copy(set);
+    t += now() - t0;
+    check(copy->len == n, "set", "copy");
+    Set_free(copy);
+  }
+  report("set", "copy", config, n * config->rounds, t);
+
+  size_t churn = n * config->rounds;
+  if (churn > config->spare) {
+    churn = config->spare;
+  }
+  t0 = now();
+  for (size_t j = 0; j < churn; j++) {
+    key_of(j, config->keySize, key);
+    Set_remove(set, key);
+    key_of(n + j, config->keySize, key);
+    Set_add(set, key);
+  }
+  report("set", "churn", config, 2 * churn, now() - t0);
+  check(set->len == n, "set", "churn");
+  Set_free(set);
+}
+
+void bench_heap(const Config *config) {
+  size_t n = config->n;
+  unsigned char key[MAX_KEY];
+  double push = 0;
+  double pop = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    double t0 = now();
+    Heap *heap = Heap_create_priority(16, config->keySize, 0);
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      Heap_add_priority(heap, (int64_t)(mix(i) >> 1), key, NULL);
+    }
+    double t1 = now();
+    int64_t last = INT64_MAX;
+    bool ordered = true;
+    while (heap->len) {
+      int64_t priority = Heap_peek_priority(heap);
+      ordered &= priority <= last;
+      last = priority;
+      Heap_pop(heap, key, NULL);
+    }
+    double t2 = now();
+    check(ordered, "heap", "pop");
+    Heap_free(heap);
+    push += t1 - t0;
+    pop += t2 - t1;
+  }
+  report("heap", "push", config, n * config->rounds, push);
+  report("heap", "pop", config, n * config->rounds, pop);
+}
+
+void bench_list(const Config *config) {
+  size_t n = config->n;
+  unsigned char key[MAX_KEY];
+  List *list = NULL;
+  double t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    if (list) {
+      List_free(list);
+    }
+    double t0 = now();
+    list = List_create(config->keySize, NULL, NULL, NULL);
+    for (size_t i = 0; i < n; i++) {
+      key_of(i, config->keySize, key);
+      List_append(list, key);
+    }
+    t += now() - t0;
+  }
+  check(list->len == n, "list", "insert");
+  report("list", "insert", config, n * config->rounds, t);
+
+  // a scan compares n / 2 elements on a hit and n on a miss
+  size_t lookups = LIST_SCAN_BUDGET / n;
+  if (lookups > n * config->rounds) {
+    lookups = n * config->rounds;
+  }
+  if (lookups == 0) {
+    lookups = 1;
+  }
+  size_t found = 0;
+  double t0 = now();
+  for (size_t j = 0; j < lookups; j++) {
+    key_of(mix(j) % n, config->keySize, key);
+    found += List_find(list, key);
+  }
+  report("list", "hit", config, lookups, now() - t0);
+  check(found == lookups, "list", "hit");
+
+  found = 0;
+  t0 = now();
+  for (size_t j = 0; j < lookups; j++) {
+    key_of(miss_index(config, j), config->keySize, key);
+    found += List_find(list, key);
+  }
+  report("list", "miss", config, lookups, now() - t0);
+  check(found == 0, "list", "miss");
+
+  size_t count = 0;
+  t0 = now();
+  for (size_t r = 0; r < config->rounds; r++) {
+    ListItem *cursor = NULL;
+    while (List_iter_next(list, &cursor)) {
+      count++;
+    }
+  }
+  report("list", "iterate", config, n * config->rounds, now() - t0);
+  check(count == n * config->rounds, "list", "iterate");
+
+  t = 0;
+  for (size_t r = 0; r < config->rounds; r++) {
+    t0 = now();
+    List *copy = List_copy(list);
+    t += now() - t0;
+    check(copy->len == n, "list", "copy");
+    List_free(copy);
+  }
+  report("list", "copy", config, n * config->rounds, t);
+
+  // queue-like: pop the head, append a new key at the tail
+  size_t churn = n * config->rounds;
+  if (churn > config->spare) {
+    churn = config->spare;
+  }
+  t0 = now();
+  for (size_t j = 0; j < churn; j++) {
+    free(List_pop(list, 0));
+    key_of(n + j, config->keySize, key);
+    List_append(list, key);
+  }
+  report("list", "churn", config, 2 * churn, now() - t0);
+  check(list->len == n, "list", "churn");
+  List_free(list);
+}
+
+typedef struct {
+  const char *name;
+  void (*run)(const Config *config);
+} Container;
+
+const Container containers[] = {{"dict", bench_dict},
+                                {"set", bench_set},
+                                {"heap", bench_heap},
+                                {"list", bench_list}};
+#define NCONTAINERS (sizeof(containers) / sizeof(containers[0]))
+
+void usage(void) {
+  fprintf(stderr, "usage: bench_containers.exe [--sizes 100,1000,...] "
+                  "[--keys 3,8,16,24] [--containers dict,set,heap,list] "
+                  "[--min-ops N]\n");
+  exit(EXIT_FAILURE);
+}
+
+// Parses a comma-separated list of positive numbers into `values`.
+size_t parse_list(char *p, size_t *values, size_t capacity) {
+  size_t len = 0;
+  while (*p) {
+    char *end;
+    double value = strtod(p, &end);
+    if (end == p || value < 1 || len == capacity || (*end && *end != ',')) {
+      usage();
+    }
+    values[len++] = value;
+    p = end + (*end == ',');
+  }
+  return len;
+}
+
+int main(int argc, char **argv) {
+  size_t sizes[16] = {100, 1000, 10000, 100000, 1000000, 10000000};
+  size_t nsizes = 6;
+  size_t keys[8] = {3, 8, 16, 24};
+  size_t nkeys = 4;
+  size_t min_ops = 1000000;
+  bool selected[NCONTAINERS];
+  memset(selected, true, sizeof(selected));
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 == argc) {
+      usage();
+    }
+    if (strcmp(argv[i], "--sizes") == 0) {
+      nsizes = parse_list(argv[++i], sizes, 16);
+    } else if (strcmp(argv[i], "--keys") == 0) {
+      nkeys = parse_list(argv[++i], keys, 8);
+    } else if (strcmp(argv[i], "--min-ops") == 0) {
+      min_ops = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--containers") == 0) {
+      memset(selected, false, sizeof(selected));
+      for (char *name = strtok(argv[++i], ","); name;
+           name = strtok(NULL, ",")) {
+        size_t c = 0;
+        while (c < NCONTAINERS && strcmp(containers[c].name, name) != 0) {
+          c++;
+        }
+        if (c == NCONTAINERS) {
+          usage();
+        }
+        selected[c] = true;
+      }
+    } else {
+      usage();
+    }
+  }
+  for (size_t k = 0; k < nkeys; k++) {
+    if (keys[k] > MAX_KEY) {
+      usage();
+    }
+  }
+
+  printf("%-5s %-8s %4s %10s %12s %12s %10s\n", "cont", "op", "key", "n",
+         "ops", "ns/op", "Mops/s");
+  for (size_t c = 0; c < NCONTAINERS; c++) {
+    for (size_t k = 0; selected[c] && k < nkeys; k++) {
+      for (size_t s = 0; s < nsizes; s++) {
+        uint64_t space = key_space(keys[k]);
+        Config config = {keys[k], sizes[s], 1, space - sizes[s]};
+        if (config.n >= space) {
+          printf("%-5s %-8s %4zu %10zu  skipped: only %llu distinct keys\n",
+                 containers[c].name, "", config.keySize, config.n,
+                 (unsigned long long)space);
+          continue;
+        }
+        if (config.n < min_ops) {
+          config.rounds = (min_ops + config.n - 1) / config.n;
+        }
+        containers[c].run(&config);
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,340 @@
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vec.h>
+
+// Runs the 2025_N.exe solvers over every input found for them and reports
+// min, median and p95 wall time, as a table on stdout and optionally as
+// JSON. The inputs for day N are the files in the input directory named
+// N, N.* or N-* (e.g. 8.txt, 8-large.txt), run in order of size.
+//
+// The solvers print one answer per line, so a run is split into phases at
+// the answer lines: phase k ends when answer k is printed and includes
+// whatever ran since the previous one (input loading counts towards part
+// 1). The solver's stdout is a pseudo-terminal, which keeps stdio line
+// buffered so every answer arrives when it is printed.
+//
+// usage: bench_days.exe --bin DIR --inputs DIR [--days 1,7,8] [--reps N]
+//                       [--warmup N] [--json FILE]
+
+#define MAX_PHASES 8
+
+typedef struct {
+  int day;
+  char path[4096];
+  long long bytes;
+} Job;
+
+typedef struct {
+  int nphases;
+  double phases[MAX_PHASES];
+  double total;
+} Run;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Whether `line` (without its newline) looks like an answer.
+bool is_answer(const char *line, size_t len) {
+  if (len && (*line == '-' || *line == '+')) {
+    line++;
+    len--;
+  }
+  if (len == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (line[i] < '0' || line[i] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs `exe` on `input` once. Returns false if it could not be started or
+// did not exit with status 0.
+bool run_once(const char *exe, const char *input, Run *run) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    perror("posix_openpt");
+    exit(EXIT_FAILURE);
+  }
+  char *slave_name = ptsname(master);
+
+  double start = now();
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    setsid();
+    int slave = open(slave_name, O_RDWR);
+    struct termios raw;
+    if (slave < 0 || tcgetattr(slave, &raw)) {
+      _exit(127);
+    }
+    // no \n -> \r\n translation or echo
+    cfmakeraw(&raw);
+    tcsetattr(slave, TCSANOW, &raw);
+    int null = open("/dev/null", O_RDWR);
+    dup2(null, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    close(master);
+    execl(exe, exe, input, (char *)NULL);
+    _exit(127);
+  }
+
+  run->nphases = 0;
+  double last = start;
+  char line[256];
+  size_t len = 0;
+  char buffer[4096];
+  while (true) {
+    ssize_t n = read(master, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // reading the master fails with EIO once the solver has exited
+    if (n <= 0) {
+      break;
+    }
+    double t = now();
+    for (ssize_t i = 0; i < n; i++) {
+      if (buffer[i] != '\n') {
+        if (len < sizeof(line)) {
+          line[len++] = buffer[i];
+        }
+        continue;
+      }
+      if (is_answer(line, len) && run->nphases < MAX_PHASES) {
+        run->phases[run->nphases++] = t - last;
+        last = t;
+      }
+      len = 0;
+    }
+  }
+  close(master);
+  int status;
+  waitpid(pid, &status, 0);
+  run->total = now() - start;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int compare_double(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+typedef struct {
+  double min;
+  double median;
+  double p95;
+} Stats;
+
+// Nearest-rank statistics of `n` samples, which are sorted in place.
+Stats stats(double *samples, int n) {
+  qsort(samples, n, sizeof(double), compare_double);
+  Stats s;
+  s.min = samples[0];
+  s.median = n % 2 ? samples[n / 2]
+                   : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+  int rank = (95 * n + 99) / 100;
+  s.p95 = samples[rank - 1];
+  return s;
+}
+
+bool input_matches(const char *name, int day) {
+  char prefix[16];
+  int len = snprintf(prefix, sizeof(prefix), "%d", day);
+  return strncmp(name, prefix, len) == 0 &&
+         (name[len] == '\0' || name[len] == '.' || name[len] == '-');
+}
+
+int compare_job(const void *a, const void *b) {
+  const Job *x = a;
+  const Job *y = b;
+  if (x->day != y->day) {
+    return x->day - y->day;
+  }
+  return (x->bytes > y->bytes) - (x->bytes < y->bytes);
+}
+
+void find_inputs(const char *dir, const bool *days, Vec *jobs) {
+  DIR *d = opendir(dir);
+  if (!d) {
+    perror(dir);
+    exit(EXIT_FAILURE);
+  }
+  struct dirent *entry;
+  while ((entry = readdir(d))) {
+    for (int day = 1; day <= 25; day++) {
+      if (!days[day] || !input_matches(entry->d_name, day)) {
+        continue;
+      }
+      Job job = {.day = day};
+      snprintf(job.path, sizeof(job.path), "%s/%s", dir, entry->d_name);
+      struct stat st;
+      if (stat(job.path, &st) == 0 && S_ISREG(st.st_mode)) {
+        job.bytes = st.st_size;
+        Vec_push(jobs, &job);
+      }
+    }
+  }
+  closedir(d);
+  Vec_sort(jobs, compare_job);
+}
+
+void usage(void) {
+  fprintf(stderr, "usage: bench_days.exe --bin DIR --inputs DIR "
+                  "[--days 1,7,8] [--reps N] [--warmup N] [--json FILE]\n");
+  exit(EXIT_FAILURE);
+}
+
+void print_stats(FILE *json, const char *name, Stats s, bool last) {
+  printf("  %-8s %10.3f %10.3f %10.3f\n", name, s.min * 1e3, s.median * 1e3,
+         s.p95 * 1e3);
+  if (json) {
+    fprintf(json,
+            "        {\"name\": \"%s\", \"min_ms\": %.4f, \"median_ms\": "
+            "%.4f, \"p95_ms\": %.4f}%s\n",
+            name, s.min * 1e3, s.median * 1e3, s.p95 * 1e3, last ? "" : ",");
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *bin = NULL;
+  const char *inputs = NULL;
+  const char *json_path = NULL;
+  int reps = 10;
+  int warmup = 2;
+  bool days[26];
+  memset(days, true, sizeof(days));
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 == argc) {
+      usage();
+    }
+    if (strcmp(argv[i], "--bin") == 0) {
+      bin = argv[++i];
+    } else if (strcmp(argv[i], "--inputs") == 0) {
+      inputs = argv[++i];
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json_path = argv[++i];
+    } else if (strcmp(argv[i], "--reps") == 0) {
+      reps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--warmup") == 0) {
+      warmup = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--days") == 0) {
+      memset(days, false, sizeof(days));
+      char *p = argv[++i];
+      while (*p) {
+        long day = strtol(p, &p, 10);
+        if (day < 1 || day > 25 || (*p && *p != ',')) {
+          usage();
+        }
+        days[day] = true;
+        p += *p == ',';
+      }
+    } else {
+      usage();
+    }
+  }
+  if (!bin || !inputs || reps < 1 || warmup < 0) {
+    usage();
+  }
+
+  Vec *jobs = Vec_create(16, sizeof(Job));
+  find_inputs(inputs, days, jobs);
+  if (jobs->len == 0) {
+    fprintf(stderr, "no inputs in %s (expected files named N, N.* or N-*)\n",
+            inputs);
+    return EXIT_FAILURE;
+  }
+  FILE *json = NULL;
+  if (json_path) {
+    json = fopen(json_path, "w");
+    if (!json) {
+      perror(json_path);
+      return EXIT_FAILURE;
+    }
+    fprintf(json, "{\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"runs\": [\n",
+            reps, warmup);
+  }
+
+  printf("%d reps after %d warmup, wall time in ms\n", reps, warmup);
+  printf("  %-8s %10s %10s %10s\n", "phase", "min", "median", "p95");
+  Run *runs = malloc(reps * sizeof(Run));
+  double *samples = malloc(reps * sizeof(double));
+  int failures = 0;
+  for (size_t j = 0; j < jobs->len; j++) {
+    Job *job = Vec_get(jobs, j);
+    char exe[4096];
+    snprintf(exe, sizeof(exe), "%s/2025_%d.exe", bin, job->day);
+    printf("day %d  %s (%lld bytes)\n", job->day, job->path, job->bytes);
+    bool ok = true;
+    for (int r = -warmup; r < reps && ok; r++) {
+      Run run;
+      ok = run_once(exe, job->path, &run);
+      if (r >= 0) {
+        runs[r] = run;
+      }
+    }
+    // phases every run agrees on
+    int nphases = MAX_PHASES;
+    for (int r = 0; r < reps && ok; r++) {
+      if (runs[r].nphases < nphases) {
+        nphases = runs[r].nphases;
+      }
+    }
+    if (!ok) {
+      printf("  failed\n");
+      failures++;
+    }
+    if (json) {
+      fprintf(json,
+              "    {\"day\": %d, \"input\": \"%s\", \"bytes\": %lld, \"ok\": "
+              "%s, \"phases\": [\n",
+              job->day, job->path, job->bytes, ok ? "true" : "false");
+    }
+    for (int k = 0; k < nphases && ok; k++) {
+      for (int r = 0; r < reps; r++) {
+        samples[r] = runs[r].phases[k];
+      }
+      char name[16];
+      snprintf(name, sizeof(name), "part %d", k + 1);
+      print_stats(json, name, stats(samples, reps), false);
+    }
+    if (ok) {
+      for (int r = 0; r < reps; r++) {
+        samples[r] = runs[r].total;
+      }
+      print_stats(json, "total", stats(samples, reps), true);
+    }
+    if (json) {
+      fprintf(json, "    ]}%s\n", j + 1 < jobs->len ? "," : "");
+    }
+  }
+  if (json) {
+    fprintf(json, "  ]\n}\n");
+    fclose(json);
+  }
+  free(runs);
+  free(samples);
+  Vec_free(jobs);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,357 @@
+#include <set.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Synthetic puzzle inputs for the 2025 days, sized by a scale parameter
+// and fully determined by the seed. What the scale counts, per day:
+//
+//    1  rotations              7  manifold rows (and columns)
+//    2  ID ranges              8  junction boxes
+//    3  battery banks          9  histogram columns (2 * scale + 2 tiles)
+//    4  grid side             10  machines
+//    5  fresh ranges (+ 5x     11  devices (at most 17571)
+//       as many IDs)          12  regions
+//    6  problems
+//
+// The inputs respect what the solvers assume of the real ones: distinct
+// junction boxes, a simple rectilinear polygon, a DAG of three-letter
+// devices, machines whose goals are reachable. Beyond a few hundred rows
+// the part 2 answer of day 7 no longer fits in 64 bits; day 11 keeps its
+// path counts in range by branching less as the graph grows.
+//
+// usage: bench_gen.exe [--seed S] DAY SCALE > input
+//        bench_gen.exe [--seed S] --dir DIR SCALE   (writes DIR/N-SCALE.txt
+//                                                    for every day)
+
+uint64_t rng_state;
+
+// splitmix64
+uint64_t rng(void) {
+  uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Uniform in [lo, hi].
+long rng_range(long lo, long hi) {
+  return lo + (long)(rng() % (uint64_t)(hi - lo + 1));
+}
+
+double rng_unit(void) { return (rng() >> 11) * 0x1.0p-53; }
+
+void gen_1(FILE *out, long scale) {
+  for (long i = 0; i < scale; i++) {
+    fprintf(out, "%c%ld\n", rng() & 1 ? 'L' : 'R', rng_range(1, 999));
+  }
+}
+
+void gen_2(FILE *out, long scale) {
+  // disjoint and increasing, as in the puzzle
+  long x = 10;
+  for (long i = 0; i < scale; i++) {
+    long a = x + rng_range(1, 1000000);
+    long b = a + rng_range(0, 10000);
+    fprintf(out, "%s%ld-%ld", i ? "," : "", a, b);
+    x = b;
+  }
+  fputc('\n', out);
+}
+
+void gen_3(FILE *out, long scale) {
+  for (long j = 0; j < scale; j++) {
+    for (int i = 0; i < 100; i++) {
+      fputc('1' + rng() % 9, out);
+    }
+    fputc('\n', out);
+  }
+}
+
+void gen_4(FILE *out, long scale) {
+  for (long j = 0; j < scale; j++) {
+    for (long i = 0; i < scale; i++) {
+      fputc(rng_unit() < 0.7 ? '@' : '.', out);
+    }
+    fputc('\n', out);
+  }
+}
+
+void gen_5(FILE *out, long scale) {
+  const long limit = 500000000000000;
+  for (long i = 0; i < scale; i++) {
+    long a = rng_range(1, limit);
+    fprintf(out, "%ld-%ld\n", a, a + rng_range(0, 1000000000000));
+  }
+  fputc('\n', out);
+  for (long i = 0; i < 5 * scale; i++) {
+    fprintf(out, "%ld\n", rng_range(1, limit));
+  }
+}
+
+void gen_6(FILE *out, long scale) {
+  const int rows = 4;
+  // mostly up to 3 digits, which keeps the grand total within 64 bits
+  const long limits[10] = {9, 9, 9, 99, 99, 99, 999, 999, 999, 9999};
+  long *numbers = malloc(scale * rows * sizeof(long));
+  int *widths = malloc(scale * sizeof(int));
+  for (long c = 0; c < scale; c++) {
+    widths[c] = 1;
+    for (int r = 0; r < rows; r++) {
+      long n = rng_range(1, limits[rng() % 10]);
+      numbers[c * rows + r] = n;
+      int width = snprintf(NULL, 0, "%ld", n);
+      widths[c] = width > widths[c] ? width : widths[c];
+    }
+  }
+  for (int r = 0; r < rows; r++) {
+    for (long c = 0; c < scale; c++) {
+      fprintf(out, rng() & 1 ? "%s%-*ld" : "%s%*ld", c ? " " : "", widths[c],
+              numbers[c * rows + r]);
+    }
+    fputc('\n', out);
+  }
+  for (long c = 0; c < scale; c++) {
+    fprintf(out, "%s%-*c", c ? " " : "", widths[c], rng() & 1 ? '+' : '*');
+  }
+  fputc('\n', out);
+  free(numbers);
+  free(widths);
+}
+
+void gen_7(FILE *out, long scale) {
+  long ny = scale < 3 ? 3 : scale;
+  long nx = ny | 1;
+  char *row = malloc(nx + 1);
+  row[nx] = '\0';
+  for (long j = 0; j < ny; j++) {
+    memset(row, '.', nx);
+    if (j == 0) {
+      row[nx / 2] = 'S';
+    } else if (j % 2 == 0 && j < ny - 1) {
+      // splitters on every other row, alternating columns
+      for (long i = 1 + (j / 2) % 2; i < nx - 1; i += 2) {
+        if (rng() & 1) {
+          row[i] = '^';
+        }
+      }
+    }
+    fprintf(out, "%s\n", row);
+  }
+  free(row);
+}
+
+void gen_8(FILE *out, long scale) {
+  Set *seen = Set_create(scale * 2, 3 * sizeof(long));
+  long n = 0;
+  while (n < scale) {
+    long p[3] = {rng_range(0, 99999), rng_range(0, 99999),
+                 rng_range(0, 99999)};
+    if (Set_find(seen, p)) {
+      continue;
+    }
+    Set_add(seen, p);
+    fprintf(out, "%ld,%ld,%ld\n", p[0], p[1], p[2]);
+    n++;
+  }
+  Set_free(seen);
+}
+
+void gen_9(FILE *out, long scale) {
+  // a histogram: columns side by side on y = 0, each of a different height
+  // than the last, so every corner turns and no edges cross
+  long n = scale < 2 ? 2 : scale;
+  long gap = 100000 / n > 1 ? 100000 / n : 1;
+  long x = rng_range(1, gap);
+  long h = 0;
+  fprintf(out, "%ld,0\n", x);
+  for (long i = 0; i < n; i++) {
+    long next;
+    do {
+      next = rng_range(1000, 90000);
+    } while (next == h);
+    h = next;
+    fprintf(out, "%ld,%ld\n", x, h);
+    x += rng_range(1, 2 * gap);
+    fprintf(out, "%ld,%ld\n", x, h);
+  }
+  fprintf(out, "%ld,0\n", x);
+}
+
+void gen_10(FILE *out, long scale) {
+  // more lights (BFS states) as the scale grows, up to what the solver's
+  // BFS queue holds
+  int max_lights = 10;
+  for (long s = scale; s > 1000 && max_lights < 16; s /= 4) {
+    max_lights++;
+  }
+  for (long m = 0; m < scale; m++) {
+    int lights = rng_range(3, max_lights);
+    int nbuttons = rng_range(lights / 2 + 1, lights + 3);
+    unsigned goal = 0;
+    int joltage[16] = {0};
+    char buttons[1024];
+    int len = 0;
+    for (int b = 0; b < nbuttons; b++) {
+      unsigned mask;
+      do {
+        mask = rng() & ((1u << lights) - 1);
+      } while (!mask);
+      // goals are a combination of presses, so both parts are solvable
+      long presses = rng_range(0, 20);
+      if (presses % 2) {
+        goal ^= mask;
+      }
+      len += sprintf(buttons + len, " (");
+      const char *sep = "";
+      for (int i = 0; i < lights; i++) {
+        if (mask >> i & 1) {
+          len += sprintf(buttons + len, "%s%d", sep, i);
+          joltage[i] += presses;
+          sep = ",";
+        }
+      }
+      buttons[len++] = ')';
+    }
+    buttons[len] = '\0';
+    fputc('[', out);
+    for (int i = 0; i < lights; i++) {
+      fputc(goal >> i & 1 ? '#' : '.', out);
+    }
+    fprintf(out, "]%s {", buttons);
+    for (int i = 0; i < lights; i++) {
+      fprintf(out, "%s%d", i ? "," : "", joltage[i]);
+    }
+    fprintf(out, "}\n");
+  }
+}
+
+void gen_11(FILE *out, long scale) {
+  static const char *reserved[] = {"you", "out", "svr", "fft", "dac"};
+  long n = scale < 12 ? 12 : scale > 17571 ? 17571 : scale;
+  char(*names)[4] = malloc((n + 1) * sizeof(*names));
+  // a multiplier coprime to 26^3 scatters the three-letter names
+  for (long id = 0, k = 0; k < n; id++) {
+    long x = id * 7919 % 17576;
+    char *name = names[k];
+    name[0] = 'a' + x / 676;
+    name[1] = 'a' + x / 26 % 26;
+    name[2] = 'a' + x % 26;
+    name[3] = '\0';
+    bool ok = true;
+    for (int r = 0; r < 5; r++) {
+      ok &= strcmp(name, reserved[r]) != 0;
+    }
+    k += ok;
+  }
+  strcpy(names[0], "svr");
+  strcpy(names[n / 4], "you");
+  strcpy(names[n / 3], "fft");
+  strcpy(names[2 * n / 3], "dac");
+  strcpy(names[n], "out");
+  // edges only lead forward to one of the next 8 devices, and to fft or
+  // dac when they are among them so that part 2 finds paths; a second edge
+  // is rare enough that the number of paths stays well within 64 bits
+  double branch = 135.0 / n < 0.5 ? 135.0 / n : 0.5;
+  for (long k = 0; k < n; k++) {
+    long a = k + rng_range(1, 8);
+    a = a > n ? n : a;
+    if (k < n / 3 && n / 3 <= k + 8) {
+      a = n / 3;
+    } else if (k < 2 * n / 3 && 2 * n / 3 <= k + 8) {
+      a = 2 * n / 3;
+    }
+    fprintf(out, "%s: %s", names[k], names[a]);
+    if (rng_unit() < branch) {
+      long b = k + rng_range(1, 8);
+      b = b > n ? n : b;
+      if (b != a) {
+        fprintf(out, " %s", names[b]);
+      }
+    }
+    fputc('\n', out);
+  }
+  free(names);
+}
+
+void gen_12(FILE *out, long scale) {
+  const int nshapes = 6;
+  for (int k = 0; k < nshapes; k++) {
+    fprintf(out, "%d:\n", k);
+    char shape[9];
+    do {
+      for (int i = 0; i < 9; i++) {
+        shape[i] = rng() % 3 ? '#' : '.';
+      }
+    } while (!memchr(shape, '#', 9));
+    for (int i = 0; i < 3; i++) {
+      fprintf(out, "%.3s\n", shape + 3 * i);
+    }
+    fputc('\n', out);
+  }
+  for (long r = 0; r < scale; r++) {
+    fprintf(out, "%ldx%ld:", rng_range(4, 50), rng_range(4, 50));
+    for (int k = 0; k < nshapes; k++) {
+      fprintf(out, " %ld", rng_range(0, 30));
+    }
+    fputc('\n', out);
+  }
+}
+
+void (*generators[])(FILE *, long) = {
+    NULL,  gen_1, gen_2, gen_3,  gen_4,  gen_5, gen_6,
+    gen_7, gen_8, gen_9, gen_10, gen_11, gen_12};
+const int ndays = sizeof(generators) / sizeof(generators[0]) - 1;
+
+// Each day draws from its own stream, so adding a day or changing one
+// generator leaves the other inputs as they were.
+void generate(FILE *out, int day, long scale, uint64_t seed) {
+  rng_state = seed * 1000003 + day;
+  generators[day](out, scale);
+}
+
+void usage(void) {
+  fprintf(stderr, "usage: bench_gen.exe [--seed S] DAY SCALE\n"
+                  "       bench_gen.exe [--seed S] --dir DIR SCALE\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+  uint64_t seed = 1;
+  int i = 1;
+  if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+    seed = strtoull(argv[i + 1], NULL, 10);
+    i += 2;
+  }
+  if (i + 3 == argc && strcmp(argv[i], "--dir") == 0) {
+    const char *dir = argv[i + 1];
+    long scale = strtol(argv[i + 2], NULL, 10);
+    if (scale < 1) {
+      usage();
+    }
+    for (int day = 1; day <= ndays; day++) {
+      char path[4096];
+      snprintf(path, sizeof(path), "%s/%d-%ld.txt", dir, day, scale);
+      FILE *out = fopen(path, "w");
+      if (!out) {
+        perror(path);
+        return EXIT_FAILURE;
+      }
+      generate(out, day, scale, seed);
+      fclose(out);
+    }
+    return EXIT_SUCCESS;
+  }
+  if (i + 2 != argc) {
+    usage();
+  }
+  int day = atoi(argv[i]);
+  long scale = strtol(argv[i + 1], NULL, 10);
+  if (day < 1 || day > ndays || scale < 1) {
+    usage();
+  }
+  generate(stdout, day, scale, seed);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+#include <dict.h>
+#include <set.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Per-insert latency while Dict and Set grow from their minimum capacity.
+// Every insert is timed individually; with incremental rehashing the max
+// should stay flat as the table grows instead of tracking its size.
+
+typedef struct {
+  long x;
+  long y;
+  long z;
+} Coordinate;
+
+uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+void report(const char *name, size_t n, uint64_t *latency, size_t rehashes) {
+  qsort(latency, n, sizeof(uint64_t), compare_u64);
+  printf("%-5s %10zu %9zu %9lu %9lu %9lu\n", name, n, rehashes,
+         (unsigned long)latency[n / 2], (unsigned long)latency[n - n / 1000 - 1],
+         (unsigned long)latency[n - 1]);
+}
+
+int main(int argc, char **argv) {
+  size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  uint64_t *latency = malloc(max_n * sizeof(uint64_t));
+
+  printf("%-5s %10s %9s %9s %9s %9s\n", "", "inserts", "rehashes", "p50 ns",
+         "p99.9 ns", "max ns");
+  for (size_t n = 1000; n <= max_n; n *= 4) {
+    Dict *dict = Dict_create(1, sizeof(Coordinate), sizeof(long), 0, 0);
+    for (size_t k = 0; k < n; k++) {
+      Coordinate key = {k, k * 7, k * 13};
+      long value = k;
+      uint64_t t0 = now_ns();
+      Dict_add(dict, &key, &value);
+      latency[k] = now_ns() - t0;
+    }
+    report("dict", n, latency, dict->rehashCount);
+    Dict_free(dict);
+
+    Set *set = Set_create(1, sizeof(Coordinate));
+    for (size_t k = 0; k < n; k++) {
+      Coordinate key = {k, k * 7, k * 13};
+      uint64_t t0 = now_ns();
+      Set_add(set, &key);
+      latency[k] = now_ns() - t0;
+    }
+    report("set", n, latency, set->rehashCount);
+    Set_free(set);
+  }
+  free(latency);
+  return 0;
+}
@@ -0,0 +1,181 @@
+#include <hash.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Compares the original djb2-style byte hash with `% capacity` indexing
+// against the seeded word-at-a-time hash with power-of-two masking, on the
+// key shapes the 2025 days actually use. Each configuration builds a
+// linear-probing table at the load the days create (capacity ~ 2n) and
+// reports probe lengths and lookup throughput.
+
+typedef size_t (*IndexFn)(const void *, size_t, size_t);
+
+size_t legacy_index(const void *key, size_t size, size_t capacity) {
+  const char *hashable = key;
+  size_t hashValue = 5381;
+  for (size_t i = 0; i < size; i++) {
+    hashValue = (hashValue << 5) + hashable[i];
+  }
+  return hashValue % capacity;
+}
+
+size_t seeded_index(const void *key, size_t size, size_t capacity) {
+  return hash(key, size, HASH_SEED) & (capacity - 1);
+}
+
+typedef struct {
+  const char *name;
+  size_t size;
+  size_t n;
+  char *hits;
+  char *misses;
+} KeySet;
+
+typedef struct {
+  size_t capacity;
+  uint32_t *slots; // 1-based index into the key array, 0 = empty
+} Table;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t rng_state = 0x853c49e6748fea9bULL;
+
+uint64_t rng(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+// day 7: (int i, int j) grid cells; misses fall just outside the grid
+KeySet make_grid(int nx, int ny) {
+  KeySet keys = {.name = "grid int[2]", .size = 2 * sizeof(int),
+                 .n = (size_t)nx * ny};
+  keys.hits = malloc(keys.n * keys.size);
+  keys.misses = malloc(keys.n * keys.size);
+  size_t k = 0;
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      int hit[2] = {i, j};
+      int miss[2] = {i + nx, j};
+      memcpy(keys.hits + k * keys.size, hit, keys.size);
+      memcpy(keys.misses + k * keys.size, miss, keys.size);
+      k++;
+    }
+  }
+  return keys;
+}
+
+// days 8/9: random long coordinates in [0, 100000)
+KeySet make_coords(const char *name, int dims, size_t n) {
+  KeySet keys = {.name = name, .size = dims * sizeof(long), .n = n};
+  keys.hits = malloc(n * keys.size);
+  keys.misses = malloc(n * keys.size);
+  for (size_t k = 0; k < n; k++) {
+    long hit[3], miss[3];
+    for (int d = 0; d < dims; d++) {
+      hit[d] = rng() % 100000;
+      miss[d] = 100000 + rng() % 100000;
+    }
+    memcpy(keys.hits + k * keys.size, hit, keys.size);
+    memcpy(keys.misses + k * keys.size, miss, keys.size);
+  }
+  return keys;
+}
+
+// day 11: three-letter node names, split between hits and misses
+KeySet make_names(void) {
+  KeySet keys = {.name = "name char[3]", .size = 3, .n = 26 * 26 * 26 / 2};
+  keys.hits = malloc(keys.n * keys.size);
+  keys.misses = malloc(keys.n * keys.size);
+  size_t k = 0;
+  for (int a = 0; a < 26 * 26 * 26; a++) {
+    char name[3] = {'a' + a / 676, 'a' + a / 26 % 26, 'a' + a % 26};
+    memcpy((a % 2 ? keys.misses : keys.hits) + k * keys.size, name, 3);
+    k += a % 2;
+  }
+  return keys;
+}
+
+// Returns the number of slots inspected to find `key` (or an empty slot).
+size_t probe(const Table *table, const KeySet *keys, IndexFn index_fn,
+             const void *key, bool power_of_two) {
+  size_t index = index_fn(key, keys->size, table->capacity);
+  size_t steps = 1;
+  while (table->slots[index]) {
+    const char *stored = keys->hits + (table->slots[index] - 1) * keys->size;
+    if (memcmp(stored, key, keys->size) == 0) {
+      break;
+    }
+    index = power_of_two ? (index + 1) & (table->capacity - 1)
+                         : (index + 1) % table->capacity;
+    steps++;
+  }
+  return steps;
+}
+
+void run(const KeySet *keys, const char *hash_name, IndexFn index_fn,
+         bool power_of_two) {
+  Table table;
+  table.capacity =
+      power_of_two ? hash_capacity(keys->n * 2) : keys->n * 2;
+  table.slots = calloc(table.capacity, sizeof(uint32_t));
+  for (size_t k = 0; k < keys->n; k++) {
+    size_t index =
+        index_fn(keys->hits + k * keys->size, keys->size, table.capacity);
+    while (table.slots[index]) {
+      index = power_of_two ? (index + 1) & (table.capacity - 1)
+                           : (index + 1) % table.capacity;
+    }
+    table.slots[index] = k + 1;
+  }
+
+  size_t total_hit = 0, max_hit = 0, total_miss = 0;
+  double t0 = now();
+  for (size_t k = 0; k < keys->n; k++) {
+    size_t steps =
+        probe(&table, keys, index_fn, keys->hits + k * keys->size, power_of_two);
+    total_hit += steps;
+    max_hit = steps > max_hit ? steps : max_hit;
+  }
+  double t1 = now();
+  for (size_t k = 0; k < keys->n; k++) {
+    total_miss += probe(&table, keys, index_fn, keys->misses + k * keys->size,
+                        power_of_two);
+  }
+  double t2 = now();
+
+  printf("%-14s %-16s %9zu %9zu %9.2f %9zu %9.2f %9.1f %9.1f\n", keys->name,
+         hash_name, keys->n, table.capacity, (double)total_hit / keys->n,
+         max_hit, (double)total_miss / keys->n, keys->n / (t1 - t0) * 1e-6,
+         keys->n / (t2 - t1) * 1e-6);
+  free(table.slots);
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+  int side = 1;
+  while ((size_t)side * side < n) {
+    side++;
+  }
+  KeySet sets[] = {make_grid(side, side), make_coords("coord long[2]", 2, n),
+                   make_coords("coord long[3]", 3, n), make_names()};
+
+  printf("%-14s %-16s %9s %9s %9s %9s %9s %9s %9s\n", "keys", "hash", "n",
+         "capacity", "avg hit", "max hit", "avg miss", "hit M/s", "miss M/s");
+  for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); i++) {
+    run(&sets[i], "djb2 % cap", legacy_index, false);
+    run(&sets[i], "seeded & mask", seeded_index, true);
+    free(sets[i].hits);
+    free(sets[i].misses);
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include <parse.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Parse throughput on generated record files held in memory: fscanf over
+// fmemopen (what the days used), a strtol loop and parse_record. Prints
+// GB/s of input consumed; the sums must agree.
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t rng_state = 1;
+
+uint64_t rng(void) {
+  rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return rng_state >> 16;
+}
+
+// `lines` records of `fields` numbers below `limit` joined by `sep`.
+char *generate(size_t lines, int fields, char sep, uint64_t limit,
+               size_t *len) {
+  size_t capacity = lines * fields * 21 + 1;
+  char *data = malloc(capacity);
+  size_t n = 0;
+  for (size_t i = 0; i < lines; i++) {
+    for (int f = 0; f < fields; f++) {
+      if (f) {
+        data[n++] = sep;
+      }
+      n += sprintf(data + n, "%lu", (unsigned long)(rng() % limit));
+    }
+    data[n++] = '\n';
+  }
+  data[n] = '\0';
+  *len = n;
+  return data;
+}
+
+void report(const char *name, size_t len, double seconds, long sum) {
+  printf("%-10s %8.3f GB/s %8.1f ms  sum %ld\n", name, len / seconds * 1e-9,
+         seconds * 1e3, sum);
+}
+
+void run(const char *title, char *data, size_t len, int fields, char sep) {
+  printf("%s (%.1f MB)\n", title, len * 1e-6);
+  char format[32];
+  snprintf(format, sizeof(format), fields == 3 ? "%%ld%c%%ld%c%%ld\n"
+                                               : "%%ld%c%%ld\n",
+           sep, sep);
+  long v[3];
+
+  double t0 = now();
+  FILE *file = fmemopen(data, len, "r");
+  long sum = 0;
+  while (fscanf(file, format, &v[0], &v[1], &v[2]) == fields) {
+    for (int f = 0; f < fields; f++) {
+      sum += v[f];
+    }
+  }
+  fclose(file);
+  report("fscanf", len, now() - t0, sum);
+
+  t0 = now();
+  sum = 0;
+  char *p = data;
+  while (*p) {
+    for (int f = 0; f < fields; f++) {
+      sum += strtol(p, &p, 10);
+      p++;
+    }
+  }
+  report("strtol", len, now() - t0, sum);
+
+  t0 = now();
+  sum = 0;
+  const char *q = data;
+  const char *end = data + len;
+  while ((q = parse_record(q, end, sep, v, fields))) {
+    for (int f = 0; f < fields; f++) {
+      sum += v[f];
+    }
+  }
+  report("parse", len, now() - t0, sum);
+}
+
+int main(int argc, char **argv) {
+  size_t lines = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  size_t len;
+  char *data = generate(lines, 3, ',', 100000, &len);
+  run("x,y,z (day 8)", data, len, 3, ',');
+  free(data);
+  data = generate(lines, 2, '-', 1000000000000ULL, &len);
+  run("a-b (day 5)", data, len, 2, '-');
+  free(data);
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <heap.h>
+#include <iheap.h>
+#include <radixheap.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Dijkstra-shaped workload on the priority queues: pop the minimum, then
+// push 0-3 successors at the popped priority plus a random cost below
+// max_cost, until n items have been pushed. Every queue sees the same
+// priority sequence, so the checksums must agree. Heap is a max-heap and
+// gets negated priorities (integer fast path) or a compare callback.
+// IHeap holds one entry per handle, so every push gets a fresh handle.
+
+typedef struct {
+  uint64_t priority;
+  uint32_t vertex;
+} Item;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t rng_state;
+
+uint32_t rng(void) {
+  rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return rng_state >> 33;
+}
+
+int compare_item(const void *a, const void *b) {
+  uint64_t x = ((const Item *)a)->priority;
+  uint64_t y = ((const Item *)b)->priority;
+  return (x < y) - (x > y);
+}
+
+#define RUN(NAME, ADD, POP, LEN)                                            \
+  do {                                                                      \
+    rng_state = 1;                                                          \
+    size_t pushed = 1;                                                      \
+    size_t ops = 1;                                                         \
+    uint64_t checksum = 0;                                                  \
+    uint64_t p = 0;                                                         \
+    uint32_t v = 0;                                                         \
+    double t0 = now();                                                      \
+    ADD;                                                                    \
+    while (LEN) {                                                           \
+      POP;                                                                  \
+      ops++;                                                                \
+      checksum += p;                                                        \
+      uint64_t base = p;                                                    \
+      int succ = pushed < n ? rng() % 4 : 0;                                \
+      for (int s = 0; s < succ; s++) {                                      \
+        v = rng();                                                          \
+        p = base + rng() % max_cost;                                        \
+        ADD;                                                                \
+        pushed++;                                                           \
+        ops++;                                                              \
+      }                                                                     \
+    }                                                                       \
+    double t = now() - t0;                                                  \
+    printf("%-12s %10zu %10.1f %20llu\n", NAME, ops, t / ops * 1e9,        \
+           (unsigned long long)checksum);                                   \
+  } while (0)
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  uint64_t max_cost = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+  printf("%-12s %10s %10s %20s\n", "queue", "ops", "ns/op", "checksum");
+
+  Heap *callback = Heap_create(16, sizeof(uint32_t), sizeof(Item),
+                               compare_item, 0, 0, 0, 0);
+  Item item;
+  RUN("heap cmp", (item = (Item){p, v}, Heap_add(callback, &v, &item)),
+      (Heap_pop(callback, &v, &item), p = item.priority), callback->len);
+  Heap_free(callback);
+
+  Heap *priority = Heap_create_priority(16, sizeof(uint32_t), 0);
+  RUN("heap int",
+      Heap_add_priority(priority, -(int64_t)p, &v, &v),
+      (p = -Heap_peek_priority(priority), Heap_pop(priority, &v, NULL)),
+      priority->len);
+  Heap_free(priority);
+
+  IHeap *indexed = IHeap_create(16, false);
+  size_t handle = 0;
+  RUN("iheap", IHeap_push(indexed, handle++, p),
+      (p = IHeap_priority(indexed, IHeap_peek(indexed)),
+       IHeap_pop(indexed, NULL)),
+      indexed->len);
+  IHeap_free(indexed);
+
+  RadixHeap *radix = RadixHeap_create(sizeof(uint32_t), 0);
+  RUN("radix heap", RadixHeap_add(radix, p, &v, &v),
+      RadixHeap_pop(radix, &p, &v, NULL), radix->len);
+  RadixHeap_free(radix);
+
+  BucketQueue *buckets = BucketQueue_create(max_cost, sizeof(uint32_t), 0);
+  RUN("bucket queue", BucketQueue_add(buckets, p, &v, &v),
+      BucketQueue_pop(buckets, &p, &v, NULL), buckets->len);
+  BucketQueue_free(buckets);
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include <dict.h>
+#include <set.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Set_find / Dict_find throughput for hits and misses at the fullest point
+// before a rehash (load just under 0.75), where probe runs are longest.
+// Built twice: bench_probe.exe uses the SSE2 control-byte scan and
+// bench_probe_scalar.exe the byte-loop fallback (-DHASH_NO_SIMD).
+
+typedef struct {
+  int i;
+  int j;
+} Coordinate;
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  size_t capacity = argc > 1 ? strtoul(argv[1], NULL, 10) : 1 << 20;
+  int repeat = argc > 2 ? atoi(argv[2]) : 5;
+  capacity = hash_capacity(capacity);
+  size_t n = capacity * LOAD_FACTOR - 1;
+  int nx = 1024;
+
+  Set *set = Set_create(capacity, sizeof(Coordinate));
+  Dict *dict = Dict_create(capacity, sizeof(Coordinate), sizeof(long), 0, 0);
+  for (size_t k = 0; k < n; k++) {
+    Coordinate c = {k % nx, k / nx};
+    long value = k;
+    Set_add(set, &c);
+    Dict_add(dict, &c, &value);
+  }
+
+#if defined(__SSE2__) && !defined(HASH_NO_SIMD)
+  const char *mode = "sse2";
+#else
+  const char *mode = "scalar";
+#endif
+  printf("%-7s %10s %10s %8s %10s %10s\n", "mode", "capacity", "len",
+         "lookup", "hit M/s", "miss M/s");
+
+  for (int which = 0; which < 2; which++) {
+    double hit_time = 0, miss_time = 0;
+    size_t hits = 0;
+    for (int r = 0; r < repeat; r++) {
+      double t0 = now();
+      for (size_t k = 0; k < n; k++) {
+        Coordinate c = {k % nx, k / nx};
+        hits += which ? Dict_find(dict, &c) : Set_find(set, &c);
+      }
+      double t1 = now();
+      for (size_t k = 0; k < n; k++) {
+        Coordinate c = {k % nx + nx, k / nx};
+        hits += which ? Dict_find(dict, &c) : Set_find(set, &c);
+      }
+      double t2 = now();
+      hit_time += t1 - t0;
+      miss_time += t2 - t1;
+    }
+    if (hits != n * repeat) {
+      printf("unexpected hit count %zu\n", hits);
+      return 1;
+    }
+    printf("%-7s %10zu %10zu %8s %10.1f %10.1f\n", mode, capacity, n,
+           which ? "Dict" : "Set", n * repeat / hit_time * 1e-6,
+           n * repeat / miss_time * 1e-6);
+  }
+
+  Set_free(set);
+  Dict_free(dict);
+  return 0;
+}
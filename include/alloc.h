@@ -0,0 +1,255 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+
+// Allocator interface taken by the *_create_with constructors. Containers
+// route their per-element allocations (list nodes, set items, boxed dict
+// values, heap items) through it; a NULL allocator means plain
+// malloc/free. `release` may be NULL when memory is only given back in
+// bulk (Arena); containers then skip per-element frees on teardown.
+typedef struct Allocator {
+  void *(*alloc)(void *state, size_t size);
+  void (*release)(void *state, void *ptr, size_t size);
+  void *state;
+  size_t allocCount;
+  size_t freeCount;
+  size_t allocBytes;
+} Allocator;
+
+static inline void *Allocator_alloc(Allocator *allocator, size_t size) {
+  if (!allocator) {
+    return malloc(size);
+  }
+  allocator->allocCount++;
+  allocator->allocBytes += size;
+  void *ptr = allocator->alloc(allocator->state, size);
+  assert(ptr);
+  return ptr;
+}
+
+static inline void *Allocator_calloc(Allocator *allocator, size_t size) {
+  if (!allocator) {
+    return calloc(1, size);
+  }
+  return memset(Allocator_alloc(allocator, size), 0, size);
+}
+
+static inline void *Allocator_copy(Allocator *allocator, const void *src,
+                                   size_t size) {
+  return memcpy(Allocator_alloc(allocator, size), src, size);
+}
+
+// `size` must be the size the block was allocated with.
+static inline void Allocator_free(Allocator *allocator, void *ptr,
+                                  size_t size) {
+  if (!allocator) {
+    free(ptr);
+  } else if (allocator->release) {
+    allocator->freeCount++;
+    allocator->release(allocator->state, ptr, size);
+  }
+}
+
+// Whether blocks have to be freed one by one.
+static inline bool Allocator_frees(const Allocator *allocator) {
+  return !allocator || allocator->release;
+}
+
+static inline void Allocator_report(const Allocator *allocator,
+                                    const char *name) {
+  fprintf(stderr, "%s: %zu allocations (%zu bytes), %zu frees\n", name,
+          allocator->allocCount, allocator->allocBytes, allocator->freeCount);
+}
+
+static inline void *Allocator_malloc_alloc(void *state, size_t size) {
+  (void)state;
+  return malloc(size);
+}
+
+static inline void Allocator_malloc_release(void *state, void *ptr,
+                                            size_t size) {
+  (void)state;
+  (void)size;
+  free(ptr);
+}
+
+// malloc/free with counters, for comparing against Arena and Pool.
+static inline Allocator Allocator_malloc(void) {
+  return (Allocator){.alloc = Allocator_malloc_alloc,
+                     .release = Allocator_malloc_release};
+}
+
+// Bump allocator: allocations are carved from blocks of at least
+// blockSize bytes and are never freed individually. Arena_reset releases
+// everything at once and keeps the first block for reuse.
+#define ARENA_ALIGN 16
+
+typedef struct ArenaBlock {
+  struct ArenaBlock *next;
+  size_t size;
+  size_t used;
+  _Alignas(ARENA_ALIGN) char data[];
+} ArenaBlock;
+
+typedef struct Arena {
+  size_t blockSize;
+  size_t blockCount;
+  ArenaBlock *block;
+  Allocator allocator;
+} Arena;
+
+static inline void Arena_add_block(Arena *arena, size_t size) {
+  if (size < arena->blockSize) {
+    size = arena->blockSize;
+  }
+  ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+  assert(block);
+  PROF_ALLOC_COUNT("arena.block", size);
+  block->next = arena->block;
+  block->size = size;
+  block->used = 0;
+  arena->block = block;
+  arena->blockCount++;
+}
+
+static inline void *Arena_alloc(Arena *arena, size_t size) {
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  if (arena->block->size - arena->block->used < size) {
+    Arena_add_block(arena, size);
+  }
+  void *ptr = arena->block->data + arena->block->used;
+  arena->block->used += size;
+  PROF_ALLOC_COUNT("arena.alloc", size);
+  return ptr;
+}
+
+static inline void *Arena_alloc_state(void *state, size_t size) {
+  return Arena_alloc((Arena *)state, size);
+}
+
+static inline Arena *Arena_create(size_t blockSize) {
+  Arena *arena = calloc(1, sizeof(Arena));
+  assert(arena);
+  arena->blockSize = blockSize;
+  Arena_add_block(arena, blockSize);
+  arena->allocator = (Allocator){.alloc = Arena_alloc_state, .state = arena};
+  return arena;
+}
+
+static inline Allocator *Arena_allocator(Arena *arena) {
+  return &arena->allocator;
+}
+
+// Frees every block but the oldest one, which is emptied. Counters are
+// kept.
+static inline void Arena_reset(Arena *arena) {
+  while (arena->block->next) {
+    ArenaBlock *next = arena->block->next;
+    free(arena->block);
+    arena->block = next;
+    arena->blockCount--;
+  }
+  arena->block->used = 0;
+}
+
+static inline void Arena_free(Arena *arena) {
+  Arena_reset(arena);
+  free(arena->block);
+  free(arena);
+}
+
+// Fixed-size allocator: blocks of sizeOfBlock bytes come from chunks of
+// blocksPerChunk and are recycled through a free list. Requests larger
+// than sizeOfBlock fall through to malloc/free.
+typedef struct PoolChunk {
+  struct PoolChunk *next;
+  _Alignas(ARENA_ALIGN) char data[];
+} PoolChunk;
+
+typedef struct Pool {
+  size_t sizeOfBlock;
+  size_t blocksPerChunk;
+  size_t chunkCount;
+  void *freeList;
+  PoolChunk *chunks;
+  Allocator allocator;
+} Pool;
+
+static inline void *Pool_alloc(Pool *pool) {
+  if (!pool->freeList) {
+    PoolChunk *chunk =
+        malloc(sizeof(PoolChunk) + pool->sizeOfBlock * pool->blocksPerChunk);
+    assert(chunk);
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->chunkCount++;
+    PROF_ALLOC_COUNT("pool.chunk", pool->sizeOfBlock * pool->blocksPerChunk);
+    for (size_t i = pool->blocksPerChunk; i-- > 0;) {
+      void *block = chunk->data + i * pool->sizeOfBlock;
+      *(void **)block = pool->freeList;
+      pool->freeList = block;
+    }
+  }
+  void *block = pool->freeList;
+  pool->freeList = *(void **)block;
+  PROF_ALLOC_COUNT("pool.alloc", pool->sizeOfBlock);
+  return block;
+}
+
+static inline void Pool_release(Pool *pool, void *block) {
+  PROF_ALLOC_COUNT("pool.free", pool->sizeOfBlock);
+  *(void **)block = pool->freeList;
+  pool->freeList = block;
+}
+
+static inline void *Pool_alloc_state(void *state, size_t size) {
+  Pool *pool = (Pool *)state;
+  return size <= pool->sizeOfBlock ? Pool_alloc(pool) : malloc(size);
+}
+
+static inline void Pool_release_state(void *state, void *ptr, size_t size) {
+  Pool *pool = (Pool *)state;
+  if (size <= pool->sizeOfBlock) {
+    Pool_release(pool, ptr);
+  } else {
+    free(ptr);
+  }
+}
+
+static inline Pool *Pool_create(size_t sizeOfBlock, size_t blocksPerChunk) {
+  Pool *pool = calloc(1, sizeof(Pool));
+  assert(pool && blocksPerChunk);
+  if (sizeOfBlock < sizeof(void *)) {
+    sizeOfBlock = sizeof(void *);
+  }
+  pool->sizeOfBlock =
+      (sizeOfBlock + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  pool->blocksPerChunk = blocksPerChunk;
+  pool->allocator = (Allocator){.alloc = Pool_alloc_state,
+                                .release = Pool_release_state,
+                                .state = pool};
+  return pool;
+}
+
+static inline Allocator *Pool_allocator(Pool *pool) { return &pool->allocator; }
+
+// Returns every block to the pool at once by dropping all chunks.
+static inline void Pool_reset(Pool *pool) {
+  while (pool->chunks) {
+    PoolChunk *next = pool->chunks->next;
+    free(pool->chunks);
+    pool->chunks = next;
+  }
+  pool->chunkCount = 0;
+  pool->freeList = NULL;
+}
+
+static inline void Pool_free(Pool *pool) {
+  Pool_reset(pool);
+  free(pool);
+}
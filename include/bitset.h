@@ -0,0 +1,100 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+
+// Dense set over the integers [0, size): one bit per possible element, so
+// add, find and remove are single word operations and nothing is hashed or
+// allocated per element. Use it instead of Set when keys map onto a bounded
+// integer range, e.g. grid cells at j * nx + i.
+typedef struct BitSet {
+  size_t size;
+  size_t nwords;
+  uint64_t *words;
+} BitSet;
+
+static inline BitSet *BitSet_create(size_t size) {
+  BitSet *set = malloc(sizeof(BitSet));
+  assert(set);
+  set->size = size;
+  set->nwords = (size + 63) / 64;
+  set->words = calloc(set->nwords ? set->nwords : 1, sizeof(uint64_t));
+  assert(set->words);
+  return set;
+}
+
+static inline void BitSet_add(BitSet *set, size_t index) {
+  assert(index < set->size);
+  set->words[index >> 6] |= 1ULL << (index & 63);
+}
+
+static inline bool BitSet_find(const BitSet *set, size_t index) {
+  assert(index < set->size);
+  return set->words[index >> 6] >> (index & 63) & 1;
+}
+
+static inline void BitSet_remove(BitSet *set, size_t index) {
+  assert(index < set->size);
+  set->words[index >> 6] &= ~(1ULL << (index & 63));
+}
+
+// Adds `index` and returns whether it was already present.
+static inline bool BitSet_test_and_add(BitSet *set, size_t index) {
+  assert(index < set->size);
+  uint64_t bit = 1ULL << (index & 63);
+  bool present = set->words[index >> 6] & bit;
+  set->words[index >> 6] |= bit;
+  return present;
+}
+
+static inline void BitSet_clear(BitSet *set) {
+  memset(set->words, 0, set->nwords * sizeof(uint64_t));
+}
+
+// Number of elements, by popcount over the words.
+static inline size_t BitSet_count(const BitSet *set) {
+  size_t count = 0;
+  for (size_t i = 0; i < set->nwords; i++) {
+    count += __builtin_popcountll(set->words[i]);
+  }
+  return count;
+}
+
+// Allocation-free iteration in increasing order: start with
+// `size_t cursor = 0` and call until it returns false.
+static inline bool BitSet_iter_next(const BitSet *set, size_t *cursor,
+                                    size_t *index) {
+  size_t word = *cursor >> 6;
+  if (word >= set->nwords) {
+    return false;
+  }
+  uint64_t bits = set->words[word] & (~0ULL << (*cursor & 63));
+  while (!bits) {
+    if (++word == set->nwords) {
+      *cursor = set->nwords * 64;
+      return false;
+    }
+    bits = set->words[word];
+  }
+  *index = word * 64 + __builtin_ctzll(bits);
+  *cursor = *index + 1;
+  return true;
+}
+
+static inline void BitSet_free(void *set_void) {
+  BitSet *set = (BitSet *)set_void;
+  free(set->words);
+  free(set);
+}
+
+static inline void *BitSet_copy(const void *src) {
+  assert(src);
+  const BitSet *srcSet = (const BitSet *)src;
+  BitSet *destSet = BitSet_create(srcSet->size);
+  memcpy(destSet->words, srcSet->words, srcSet->nwords * sizeof(uint64_t));
+  return destSet;
+}
@@ -1,218 +1,476 @@
+#pragma once
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "hash.h"
+#include "prof.h"
 
 #define LOAD_FACTOR 0.75
-#define DELETED ((void *)-1)
+// Old-table slots migrated by every insert or remove while a rehash is in
+// progress. Growth doubles the table at 0.75 load, so any step >= 2
+// finishes the migration before the new table fills up.
+#define REHASH_STEP 16
 
 typedef struct DictItem {
     void *key;
     void *value;
 } DictItem;
 
+// Slot i keeps its key at keys + i * sizeOfKey, its value at
+// values + i * sizeOfSlot and its control byte (hash.h) at ctrl[i]. Removal
+// shifts entries back instead of leaving tombstones, so a probe always ends
+// at the first empty slot; CTRL_DELETED only appears in a table that is
+// being drained by a rehash.
+typedef struct DictTable {
+    size_t capacity;
+    unsigned char *ctrl;
+    char *keys;
+    char *values;
+} DictTable;
+
+// Open-addressing dictionary.
+//
+// Plain values are copied inline (sizeOfSlot == sizeOfValue). When
+// copy_value or free_value is given the dictionary owns a heap object per
+// entry instead, and the slot holds the pointer (sizeOfSlot ==
+// sizeof(void *)); Dict_get then returns that pointer as before. Boxed
+// values made without copy_value come from `allocator` (NULL for malloc).
+//
+// Growth is incremental: `old` keeps the previous table while its slots
+// from rehashIndex onwards are moved into `table`, REHASH_STEP at a time.
+// Lookups check both. Slots of `old` below rehashIndex have been moved and
+// are never read again.
 typedef struct Dict {
     size_t sizeOfKey;
     size_t sizeOfValue;
+    size_t sizeOfSlot;
     size_t len;
-    size_t capacity;
-    DictItem **table;
+    uint64_t seed;
+    DictTable table;
+    DictTable old;
+    size_t rehashIndex;
+    size_t rehashCount;
     void *(*copy_value)(const void *);
     void (*free_value)(void *);
+    Allocator *allocator;
 } Dict;
 
-Dict *Dict_create(size_t capacity, size_t sizeOfKey, size_t sizeOfValue,
-                  void *(*copy_value)(const void *),
-                  void (*free_value)(void *)) {
-    Dict *dict = malloc(sizeof(Dict));
+static inline bool Dict_boxed(const Dict *dict) {
+    return dict->copy_value || dict->free_value;
+}
+
+static inline void *Dict_key_at(const Dict *dict, const DictTable *table,
+                                size_t index) {
+    return table->keys + index * dict->sizeOfKey;
+}
+
+static inline void *Dict_slot_at(const Dict *dict, const DictTable *table,
+                                 size_t index) {
+    return table->values + index * dict->sizeOfSlot;
+}
+
+static inline void *Dict_value_at(const Dict *dict, const DictTable *table,
+                                  size_t index) {
+    void *slot = Dict_slot_at(dict, table, index);
+    if (Dict_boxed(dict)) {
+        return *(void **)slot;
+    }
+    return slot;
+}
+
+static inline uint64_t Dict_hash(const Dict *dict, const void *key) {
+    return hash(key, dict->sizeOfKey, dict->seed);
+}
+
+static inline void Dict_alloc_table(Dict *dict, DictTable *table,
+                                    size_t capacity) {
+    table->capacity = capacity;
+    table->ctrl = ctrl_alloc(capacity);
+    table->keys = malloc(capacity * dict->sizeOfKey);
+    table->values = malloc(capacity * dict->sizeOfSlot);
+    assert(table->ctrl && table->keys && table->values);
+}
+
+static inline void Dict_free_table(DictTable *table) {
+    free(table->ctrl);
+    free(table->keys);
+    free(table->values);
+    *table = (DictTable){0};
+}
+
+static inline Dict *Dict_create_with(size_t capacity, size_t sizeOfKey,
+                                     size_t sizeOfValue,
+                                     void *(*copy_value)(const void *),
+                                     void (*free_value)(void *),
+                                     Allocator *allocator) {
+    Dict *dict = calloc(1, sizeof(Dict));
     assert(dict);
     dict->sizeOfKey = sizeOfKey;
     dict->sizeOfValue = sizeOfValue;
     dict->len = 0;
-    assert(capacity);
-    dict->capacity = capacity;
-    dict->table = calloc(dict->capacity, sizeof(DictItem *));
+    dict->seed = HASH_SEED;
     dict->copy_value = copy_value;
     dict->free_value = free_value;
+    dict->allocator = allocator;
+    dict->sizeOfSlot = Dict_boxed(dict) ? sizeof(void *) : sizeOfValue;
+    assert(capacity);
+    Dict_alloc_table(dict, &dict->table, hash_capacity(capacity));
     return dict;
 }
 
-void Dict_add(Dict *dict, const void *key, const void *value) {
-    assert(dict);
-    if (dict->len == dict->capacity * LOAD_FACTOR) {
-        printf("Warning: rehashing dictionary!\n");
-        size_t capacity = dict->capacity * 2;
-        DictItem **table = calloc(capacity, sizeof(DictItem *));
-        for (int i = 0; i < dict->capacity; i++) {
-            if (dict->table[i] != NULL && dict->table[i] != DELETED) {
-                size_t index =
-                    hash(dict->table[i]->key, dict->sizeOfKey, capacity);
-                while (table[index]) {
-                    index = (index + 1) % capacity;
-                }
-                table[index] = dict->table[i];
+static inline Dict *Dict_create(size_t capacity, size_t sizeOfKey,
+                                size_t sizeOfValue,
+                                void *(*copy_value)(const void *),
+                                void (*free_value)(void *)) {
+    return Dict_create_with(capacity, sizeOfKey, sizeOfValue, copy_value,
+                            free_value, NULL);
+}
+
+// Returns the slot of `table` holding `key`, or the empty slot where it
+// should be inserted. Each step looks at a whole group of control bytes and
+// compares keys only where the tag matches before the first empty slot.
+// Matches below `start` are ignored (see Dict_probe_old).
+static inline size_t Dict_probe(const Dict *dict, const DictTable *table,
+                                const void *key, uint64_t h, size_t start,
+                                bool *found) {
+    size_t mask = table->capacity - 1;
+    unsigned char tag = hash_tag(h);
+    size_t pos = h & mask;
+    PROF_COUNT("dict.probe", 1);
+    while (true) {
+        unsigned int empty = ctrl_match(table->ctrl + pos, CTRL_EMPTY);
+        unsigned int match = ctrl_match(table->ctrl + pos, tag);
+        if (empty) {
+            match &= (empty & -empty) - 1;
+        }
+        while (match) {
+            size_t index = (pos + __builtin_ctz(match)) & mask;
+            if (index >= start &&
+                memcmp(Dict_key_at(dict, table, index), key,
+                       dict->sizeOfKey) == 0) {
+                *found = true;
+                return index;
             }
+            match &= match - 1;
         }
-        free(dict->table);
-        dict->table = table;
-        dict->capacity = capacity;
-    }
-    size_t index = hash(key, dict->sizeOfKey, dict->capacity);
-    while (dict->table[index]) {
-        if (dict->table[index] == DELETED) {
-            index = (index + 1) % dict->capacity;
-            continue;
+        if (empty) {
+            *found = false;
+            return (pos + __builtin_ctz(empty)) & mask;
         }
-        if (memcmp(dict->table[index]->key, key, dict->sizeOfKey) == 0) {
-            if (dict->free_value) {
-                dict->free_value(dict->table[index]->value);
-            } else {
-                free(dict->table[index]->value);
-            }
-            dict->table[index]->value = NULL;
-            if (dict->copy_value) {
-                dict->table[index]->value = dict->copy_value(value);
-            } else {
-                dict->table[index]->value = malloc(dict->sizeOfValue);
-                memcpy(dict->table[index]->value, value, dict->sizeOfValue);
-            }
-            return;
+        pos = (pos + CTRL_GROUP) & mask;
+        PROF_COUNT("dict.probe.next_group", 1);
+    }
+}
+
+// Looks `key` up in the table being drained. Only slots at or after
+// rehashIndex still hold live entries. *index is only written on a hit, so
+// callers can keep the insertion slot of the current table in it.
+static inline bool Dict_probe_old(const Dict *dict, const void *key, uint64_t h,
+                                  size_t *index) {
+    if (!dict->old.capacity) {
+        return false;
+    }
+    bool found;
+    size_t slot = Dict_probe(dict, &dict->old, key, h, dict->rehashIndex,
+                             &found);
+    if (found) {
+        *index = slot;
+    }
+    return found;
+}
+
+static inline bool Dict_locate(const Dict *dict, const void *key,
+                               const DictTable **table, size_t *index) {
+    uint64_t h = Dict_hash(dict, key);
+    bool found;
+    *index = Dict_probe(dict, &dict->table, key, h, 0, &found);
+    *table = &dict->table;
+    if (!found && Dict_probe_old(dict, key, h, index)) {
+        *table = &dict->old;
+        found = true;
+    }
+    return found;
+}
+
+// Copies slot `index` of `from` into the current table, which must not
+// already hold its key.
+static inline void Dict_move(Dict *dict, const DictTable *from, size_t index) {
+    const void *key = Dict_key_at(dict, from, index);
+    uint64_t h = Dict_hash(dict, key);
+    bool found;
+    size_t dest = Dict_probe(dict, &dict->table, key, h, 0, &found);
+    assert(!found);
+    ctrl_set(dict->table.ctrl, dict->table.capacity, dest, hash_tag(h));
+    memcpy(Dict_key_at(dict, &dict->table, dest), key, dict->sizeOfKey);
+    memcpy(Dict_slot_at(dict, &dict->table, dest),
+           Dict_slot_at(dict, from, index), dict->sizeOfSlot);
+}
+
+static inline void Dict_rehash_step(Dict *dict, size_t steps) {
+    if (!dict->old.capacity) {
+        return;
+    }
+    for (; steps && dict->rehashIndex < dict->old.capacity; steps--) {
+        if (ctrl_full(dict->old.ctrl[dict->rehashIndex])) {
+            PROF_COUNT("dict.rehash.move", 1);
+            Dict_move(dict, &dict->old, dict->rehashIndex);
         }
-        index = (index + 1) % dict->capacity;
+        dict->rehashIndex++;
+    }
+    if (dict->rehashIndex == dict->old.capacity) {
+        Dict_free_table(&dict->old);
+        dict->rehashIndex = 0;
     }
+}
+
+// Starts moving entries into a table twice the size. A rehash that is
+// still running is finished first.
+static inline void Dict_grow(Dict *dict) {
+    Dict_rehash_step(dict, SIZE_MAX);
+    PROF_COUNT("dict.grow", 1);
+    dict->old = dict->table;
+    dict->rehashIndex = 0;
+    dict->rehashCount++;
+    Dict_alloc_table(dict, &dict->table, dict->old.capacity * 2);
+}
 
-    DictItem *item = malloc(sizeof(DictItem));
-    assert(item);
-    item->key = copy_hashable(key, dict->sizeOfKey);
-    if (dict->copy_value) {
-        item->value = dict->copy_value(value);
+// Walks the live slots of both tables; *cursor starts at 0.
+static inline bool Dict_next_slot(const Dict *dict, size_t *cursor,
+                                  const DictTable **table, size_t *index) {
+    while (*cursor < dict->table.capacity) {
+        size_t i = (*cursor)++;
+        if (ctrl_full(dict->table.ctrl[i])) {
+            *table = &dict->table;
+            *index = i;
+            return true;
+        }
+    }
+    while (*cursor - dict->table.capacity < dict->old.capacity) {
+        size_t i = (*cursor)++ - dict->table.capacity;
+        if (i >= dict->rehashIndex && ctrl_full(dict->old.ctrl[i])) {
+            *table = &dict->old;
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Allocation-free iteration: start with `size_t cursor = 0` and call until
+// it returns false; item->key and item->value point into the table. The
+// dict must not be modified while iterating.
+static inline bool Dict_iter_next(const Dict *dict, size_t *cursor,
+                                  DictItem *item) {
+    const DictTable *table;
+    size_t index;
+    if (!Dict_next_slot(dict, cursor, &table, &index)) {
+        return false;
+    }
+    item->key = Dict_key_at(dict, table, index);
+    item->value = Dict_value_at(dict, table, index);
+    return true;
+}
+
+static inline void Dict_store_value(Dict *dict, void *slot, const void *value) {
+    if (!Dict_boxed(dict)) {
+        memcpy(slot, value, dict->sizeOfValue);
+    } else if (dict->copy_value) {
+        *(void **)slot = dict->copy_value(value);
     } else {
-        item->value = calloc(1, dict->sizeOfValue);
-        memcpy(item->value, value, dict->sizeOfValue);
+        *(void **)slot =
+            Allocator_copy(dict->allocator, value, dict->sizeOfValue);
     }
-    dict->table[index] = item;
-    dict->len++;
 }
 
-void *Dict_get(const Dict *dict, const void *key) {
+static inline void Dict_release_value(Dict *dict, void *slot) {
+    if (!Dict_boxed(dict)) {
+        return;
+    }
+    if (dict->free_value) {
+        dict->free_value(*(void **)slot);
+    } else if (dict->copy_value) {
+        free(*(void **)slot);
+    } else {
+        Allocator_free(dict->allocator, *(void **)slot, dict->sizeOfValue);
+    }
+}
+
+// Finds or claims the slot for `key` with a single probe of each table. A
+// claimed slot has its key written and its value zeroed; *found tells which
+// case happened. Returns the value slot.
+static inline void *Dict_claim(Dict *dict, const void *key, bool *found) {
     assert(dict);
-    void *value = NULL;
-    size_t index = hash(key, dict->sizeOfKey, dict->capacity);
-    while (dict->table[index]) {
-        if (dict->table[index] == DELETED) {
-            index = (index + 1) % dict->capacity;
-            continue;
-        }
-        if (memcmp(dict->table[index]->key, key, dict->sizeOfKey) == 0) {
-            value = dict->table[index]->value;
-            break;
-        }
-        index = (index + 1) % dict->capacity;
+    Dict_rehash_step(dict, REHASH_STEP);
+    uint64_t h = Dict_hash(dict, key);
+    size_t index = Dict_probe(dict, &dict->table, key, h, 0, found);
+    if (*found) {
+        return Dict_slot_at(dict, &dict->table, index);
+    }
+    if (Dict_probe_old(dict, key, h, &index)) {
+        *found = true;
+        return Dict_slot_at(dict, &dict->old, index);
+    }
+    if (dict->len >= dict->table.capacity * LOAD_FACTOR) {
+        Dict_grow(dict);
+        index = Dict_probe(dict, &dict->table, key, h, 0, found);
+    }
+    ctrl_set(dict->table.ctrl, dict->table.capacity, index, hash_tag(h));
+    memcpy(Dict_key_at(dict, &dict->table, index), key, dict->sizeOfKey);
+    void *slot = Dict_slot_at(dict, &dict->table, index);
+    memset(slot, 0, dict->sizeOfSlot);
+    dict->len++;
+    return slot;
+}
+
+static inline void Dict_add(Dict *dict, const void *key, const void *value) {
+    bool found;
+    void *slot = Dict_claim(dict, key, &found);
+    if (found) {
+        Dict_release_value(dict, slot);
     }
-    assert(value);
-    return value;
+    Dict_store_value(dict, slot, value);
+}
+
+// Returns the value slot for `key`, inserting a zero-filled one if the key
+// is absent. For dicts with copy_value/free_value the slot is the `void *`
+// owning the value, and a new slot must be filled before the next Dict_free.
+// The pointer is valid until the next insertion or removal.
+static inline void *Dict_entry(Dict *dict, const void *key, bool *found) {
+    return Dict_claim(dict, key, found);
 }
 
-void **Dict_keys(const Dict *dict) {
+static inline void *Dict_get(const Dict *dict, const void *key) {
+    assert(dict);
+    const DictTable *table;
+    size_t index;
+    bool found = Dict_locate(dict, key, &table, &index);
+    assert(found);
+    return Dict_value_at(dict, table, index);
+}
+
+static inline void **Dict_keys(const Dict *dict) {
     void **keys = malloc(dict->len * sizeof(void *));
     size_t index = 0;
-    for (int i = 0; i < dict->capacity; i++) {
-        if (dict->table[i] != NULL && dict->table[i] != DELETED) {
-            keys[index++] = dict->table[i]->key;
-        }
+    size_t cursor = 0;
+    const DictTable *table;
+    size_t i;
+    while (Dict_next_slot(dict, &cursor, &table, &i)) {
+        keys[index++] = Dict_key_at(dict, table, i);
     }
     return keys;
 }
 
-void **Dict_values(const Dict *dict) {
+static inline void **Dict_values(const Dict *dict) {
     void **values = malloc(dict->len * sizeof(void *));
     size_t index = 0;
-    for (int i = 0; i < dict->capacity; i++) {
-        if (dict->table[i] != NULL && dict->table[i] != DELETED) {
-            values[index++] = dict->table[i]->value;
-        }
+    size_t cursor = 0;
+    const DictTable *table;
+    size_t i;
+    while (Dict_next_slot(dict, &cursor, &table, &i)) {
+        values[index++] = Dict_value_at(dict, table, i);
     }
     return values;
 }
 
-DictItem **Dict_items(const Dict *dict) {
-    DictItem **items = malloc(dict->len * sizeof(DictItem *));
+static inline DictItem *Dict_items(const Dict *dict) {
+    DictItem *items = malloc(dict->len * sizeof(DictItem));
     size_t index = 0;
-    for (int i = 0; i < dict->capacity; i++) {
-        if (dict->table[i] != NULL && dict->table[i] != DELETED) {
-            items[index] = dict->table[i];
-            index++;
-        }
+    size_t cursor = 0;
+    const DictTable *table;
+    size_t i;
+    while (Dict_next_slot(dict, &cursor, &table, &i)) {
+        items[index].key = Dict_key_at(dict, table, i);
+        items[index].value = Dict_value_at(dict, table, i);
+        index++;
     }
     return items;
 }
 
-void *Dict_return(const void *src) { return src; }
+static inline void *Dict_return(const void *src) { return src; }
 
-void *Dict_copy(const void *src) {
+static inline void *Dict_copy(const void *src) {
     assert(src);
     Dict *srcDict = (Dict *)src;
-    Dict *destDict =
-        Dict_create(srcDict->capacity, srcDict->sizeOfKey, srcDict->sizeOfValue,
-                    srcDict->copy_value, srcDict->free_value);
-    for (size_t i = 0; i < srcDict->capacity; i++) {
-        if (srcDict->table[i] != NULL && srcDict->table[i] != DELETED) {
-            Dict_add(destDict, srcDict->table[i]->key,
-                     srcDict->table[i]->value);
-        }
+    Dict *destDict = Dict_create_with(
+        srcDict->table.capacity, srcDict->sizeOfKey, srcDict->sizeOfValue,
+        srcDict->copy_value, srcDict->free_value, srcDict->allocator);
+    size_t cursor = 0;
+    const DictTable *table;
+    size_t i;
+    while (Dict_next_slot(srcDict, &cursor, &table, &i)) {
+        Dict_add(destDict, Dict_key_at(srcDict, table, i),
+                 Dict_value_at(srcDict, table, i));
     }
     return destDict;
 }
 
-void Dict_free(void *dict_void) {
+static inline void Dict_free(void *dict_void) {
     Dict *dict = (Dict *)dict_void;
-    for (size_t i = 0; i < dict->capacity; i++) {
-        if (dict->table[i] != NULL && dict->table[i] != DELETED) {
-            free(dict->table[i]->key);
-            if (dict->free_value) {
-                dict->free_value(dict->table[i]->value);
-            } else {
-                free(dict->table[i]->value);
-            }
-            free(dict->table[i]);
-        }
+    size_t cursor = 0;
+    const DictTable *table;
+    size_t i;
+    // boxed values from an arena go away with the arena
+    bool release = Dict_boxed(dict) &&
+                   (dict->free_value || dict->copy_value ||
+                    Allocator_frees(dict->allocator));
+    while (release && Dict_next_slot(dict, &cursor, &table, &i)) {
+        Dict_release_value(dict, Dict_slot_at(dict, table, i));
     }
-    free(dict->table);
+    Dict_free_table(&dict->table);
+    Dict_free_table(&dict->old);
     free(dict);
 }
 
-bool Dict_find(const Dict *dict, const void *key) {
+static inline bool Dict_find(const Dict *dict, const void *key) {
     assert(dict);
-    size_t index = hash(key, dict->sizeOfKey, dict->capacity);
-    while (dict->table[index]) {
-        if (dict->table[index] == DELETED) {
-            index = (index + 1) % dict->capacity;
-            continue;
-        }
-        if (memcmp(dict->table[index]->key, key, dict->sizeOfKey) == 0) {
-            return true;
+    const DictTable *table;
+    size_t index;
+    return Dict_locate(dict, key, &table, &index);
+}
+
+// Empties slot `index` of the current table and shifts the rest of its
+// probe run back so that no entry is left behind a hole. An entry at j may
+// move into the hole at i unless its home slot lies cyclically in (i, j].
+static inline void Dict_remove_at(Dict *dict, size_t index) {
+    DictTable *table = &dict->table;
+    size_t mask = table->capacity - 1;
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while (table->ctrl[next] != CTRL_EMPTY) {
+        size_t home = Dict_hash(dict, Dict_key_at(dict, table, next)) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            memcpy(Dict_key_at(dict, table, hole),
+                   Dict_key_at(dict, table, next), dict->sizeOfKey);
+            memcpy(Dict_slot_at(dict, table, hole),
+                   Dict_slot_at(dict, table, next), dict->sizeOfSlot);
+            ctrl_set(table->ctrl, table->capacity, hole, table->ctrl[next]);
+            hole = next;
         }
-        index = (index + 1) % dict->capacity;
+        next = (next + 1) & mask;
     }
-    return false;
+    ctrl_set(table->ctrl, table->capacity, hole, CTRL_EMPTY);
 }
 
-void Dict_remove(Dict *dict, const void *key) {
+static inline void Dict_remove(Dict *dict, const void *key) {
     assert(dict);
-    size_t index = hash(key, dict->sizeOfKey, dict->capacity);
-    while (dict->table[index] != NULL && dict->table[index] != DELETED) {
-        if (memcmp(dict->table[index]->key, key, dict->sizeOfKey) == 0) {
-            free(dict->table[index]->key);
-            free(dict->table[index]->value);
-            free(dict->table[index]);
-            dict->table[index] = DELETED;
-            dict->len--;
-            return;
-        }
-        index = (index + 1) % dict->capacity;
+    Dict_rehash_step(dict, REHASH_STEP);
+    const DictTable *table;
+    size_t index;
+    if (!Dict_locate(dict, key, &table, &index)) {
+        return;
     }
-    return;
-}
\ No newline at end of file
+    Dict_release_value(dict, Dict_slot_at(dict, table, index));
+    if (table == &dict->table) {
+        Dict_remove_at(dict, index);
+    } else {
+        // shifting inside the old table could move unmigrated entries
+        // below rehashIndex, so leave a tombstone there instead
+        ctrl_set(dict->old.ctrl, dict->old.capacity, index, CTRL_DELETED);
+    }
+    dict->len--;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input.h"
+
+// Character grid surrounded by a one-cell halo of `pad` bytes. Cell (i, j)
+// for -1 <= i <= nx and -1 <= j <= ny is origin[j * stride + i], so the
+// 4 or 8 neighbours of any interior cell can be read through the fixed
+// offsets in n4/n8 without bounds checks. Rows are contiguous
+// (row-major); Grid_transpose gives the column-major view, in which
+// column i of the original is row i.
+typedef struct Grid {
+  int nx;
+  int ny;
+  int stride;
+  char pad;
+  char *cells;
+  char *origin;
+  int n4[4];
+  int n8[8];
+} Grid;
+
+static inline Grid *Grid_create(int nx, int ny, char pad) {
+  Grid *grid = malloc(sizeof(Grid));
+  assert(grid && nx >= 0 && ny >= 0);
+  grid->nx = nx;
+  grid->ny = ny;
+  grid->stride = nx + 2;
+  grid->pad = pad;
+  grid->cells = malloc((size_t)grid->stride * (ny + 2));
+  assert(grid->cells);
+  memset(grid->cells, pad, (size_t)grid->stride * (ny + 2));
+  grid->origin = grid->cells + grid->stride + 1;
+  int s = grid->stride;
+  int n4[4] = {-s, -1, 1, s};
+  int n8[8] = {-s - 1, -s, -s + 1, -1, 1, s - 1, s, s + 1};
+  memcpy(grid->n4, n4, sizeof(n4));
+  memcpy(grid->n8, n8, sizeof(n8));
+  return grid;
+}
+
+// Copies the lines of `input` into a grid of input->nx by input->ny.
+// Shorter lines are completed with `pad`, longer ones cut.
+static inline Grid *Grid_from_input(const Input *input, char pad) {
+  Grid *grid = Grid_create(input->nx, input->ny, pad);
+  for (int j = 0; j < grid->ny; j++) {
+    size_t len = Input_line_len(input, j);
+    memcpy(grid->origin + (size_t)j * grid->stride, Input_line(input, j),
+           len < (size_t)grid->nx ? len : (size_t)grid->nx);
+  }
+  return grid;
+}
+
+static inline char *Grid_at(const Grid *grid, int i, int j) {
+  assert(-1 <= i && i <= grid->nx && -1 <= j && j <= grid->ny);
+  return grid->origin + (ptrdiff_t)j * grid->stride + i;
+}
+
+static inline char *Grid_row(const Grid *grid, int j) {
+  return Grid_at(grid, 0, j);
+}
+
+// Grid coordinates of a cell pointer.
+static inline void Grid_coords(const Grid *grid, const char *cell, int *i,
+                               int *j) {
+  ptrdiff_t offset = cell - grid->origin + grid->stride + 1;
+  *i = offset % grid->stride - 1;
+  *j = offset / grid->stride - 1;
+}
+
+// Neighbours of `cell` (4 or 8 around) equal to `c`.
+static inline int Grid_count4(const Grid *grid, const char *cell, char c) {
+  int count = 0;
+  for (int k = 0; k < 4; k++) {
+    count += cell[grid->n4[k]] == c;
+  }
+  return count;
+}
+
+static inline int Grid_count8(const Grid *grid, const char *cell, char c) {
+  int count = 0;
+  for (int k = 0; k < 8; k++) {
+    count += cell[grid->n8[k]] == c;
+  }
+  return count;
+}
+
+// Column-major copy: cell (i, j) of `grid` is cell (j, i) of the result.
+static inline Grid *Grid_transpose(const Grid *grid) {
+  Grid *result = Grid_create(grid->ny, grid->nx, grid->pad);
+  for (int j = 0; j < grid->ny; j++) {
+    const char *row = Grid_row(grid, j);
+    for (int i = 0; i < grid->nx; i++) {
+      result->origin[(ptrdiff_t)i * result->stride + j] = row[i];
+    }
+  }
+  return result;
+}
+
+static inline void Grid_free(Grid *grid) {
+  free(grid->cells);
+  free(grid);
+}
@@ -1,16 +1,130 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-size_t hash(const char *hashable, size_t sizeOfHashable, size_t capacity) {
-    size_t hashValue = 5381;
-    for (size_t i = 0; i < sizeOfHashable; i++) {
-        hashValue = (hashValue << 5) + hashable[i];
+#include "prof.h"
+
+// Default seed for every container; override with -DHASH_SEED=... to
+// perturb the table layout between runs.
+#ifndef HASH_SEED
+#define HASH_SEED 0x2d358dccaa6c78a5ULL
+#endif
+
+#define HASH_K1 0xa0761d6478bd642fULL
+#define HASH_K2 0xe7037ed1a0b428dbULL
+#define HASH_K3 0x8ebc6af09c88c6e3ULL
+
+// 64x64 -> 128 bit multiply folded back to 64 bits.
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t hash_read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Seeded hash that consumes 16 bytes per round and reads short tails with
+// two overlapping loads, so 8-24 byte keys take one or two multiplies.
+static inline uint64_t hash(const void *hashable, size_t sizeOfHashable,
+                            uint64_t seed) {
+    const unsigned char *p = hashable;
+    size_t len = sizeOfHashable;
+    uint64_t h = seed ^ hash_mix(seed ^ HASH_K1, len ^ HASH_K2);
+    while (len > 16) {
+        h = hash_mix(hash_read64(p) ^ HASH_K1, hash_read64(p + 8) ^ h);
+        p += 16;
+        len -= 16;
+    }
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len > 8) {
+        a = hash_read64(p);
+        b = hash_read64(p + len - 8);
+    } else if (len >= 4) {
+        a = hash_read32(p);
+        b = hash_read32(p + len - 4);
+    } else if (len > 0) {
+        a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+    }
+    return hash_mix(HASH_K3 ^ sizeOfHashable,
+                    hash_mix(a ^ HASH_K1, b ^ h ^ HASH_K2));
+}
+
+// Containers keep power-of-two capacities and index with hash & (cap - 1).
+// The minimum is one control-byte group (see below).
+static inline size_t hash_capacity(size_t capacity) {
+    size_t result = 16;
+    while (result < capacity) {
+        result <<= 1;
     }
-    return hashValue % capacity;
+    return result;
 }
 
-char *copy_hashable(const void *src, size_t sizeOfHashable) {
+// Control bytes: every slot has one byte next to the table. Empty slots
+// are 0, tombstones 1, and full slots store 0x80 | the top 7 hash bits, so
+// a lookup compares full keys only where the tag matches. Probing scans
+// CTRL_GROUP bytes at once (SSE2 when available, 8-byte SWAR otherwise).
+// The first CTRL_GROUP - 1 bytes are mirrored after the end of the array so
+// a group load never needs to wrap.
+#define CTRL_EMPTY 0
+#define CTRL_DELETED 1
+#define CTRL_GROUP 16
+
+#if defined(__SSE2__) && !defined(HASH_NO_SIMD)
+#include <emmintrin.h>
+#endif
+
+static inline unsigned char hash_tag(uint64_t h) { return 0x80 | (h >> 57); }
+
+static inline bool ctrl_full(unsigned char c) { return c & 0x80; }
+
+// Bit i is set when ctrl[i] == byte, for i < CTRL_GROUP.
+static inline unsigned int ctrl_match(const unsigned char *ctrl,
+                                      unsigned char byte) {
+#if defined(__SSE2__) && !defined(HASH_NO_SIMD)
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+#else
+    // SWAR: exact per-byte zero test on each 8-byte half, then gather the
+    // high bits of the bytes into the low bits of the result.
+    unsigned int mask = 0;
+    for (int half = 0; half < 2; half++) {
+        uint64_t x = hash_read64(ctrl + 8 * half) ^
+                     (0x0101010101010101ULL * byte);
+        uint64_t zero = ~(((x & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) |
+                          x | 0x7f7f7f7f7f7f7f7fULL);
+        mask |= (unsigned int)(((zero >> 7) * 0x0102040810204080ULL) >> 56)
+                << (8 * half);
+    }
+    return mask;
+#endif
+}
+
+static inline unsigned char *ctrl_alloc(size_t capacity) {
+    return calloc(capacity + CTRL_GROUP - 1, sizeof(unsigned char));
+}
+
+static inline void ctrl_set(unsigned char *ctrl, size_t capacity, size_t index,
+                            unsigned char byte) {
+    ctrl[index] = byte;
+    if (index < CTRL_GROUP - 1) {
+        ctrl[capacity + index] = byte;
+    }
+}
+
+static inline char *copy_hashable(const void *src, size_t sizeOfHashable) {
     char *dest = malloc(sizeOfHashable);
     memcpy(dest, src, sizeOfHashable);
     return dest;
-}
\ No newline at end of file
+}
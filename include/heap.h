@@ -1,20 +1,46 @@
+#pragma once
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "prof.h"
+
 typedef struct HeapItem {
   void *key;
   void *value;
 } HeapItem;
 
+// Binary max-heap storing items inline in one array of sizeOfEntry-byte
+// entries laid out as [priority][key][value]:
+//
+// - With compare_value, the item whose value compares greatest pops first
+//   and there is no priority field.
+// - Heaps from Heap_create_priority keep an int64_t priority in front of
+//   every entry and compare it directly; the largest priority pops first
+//   (push -cost for a min-heap).
+//
+// Keys and values are copied inline unless copy_/free_ callbacks are
+// given, in which case their slot holds the owned pointer, as in Dict.
+// Sifting moves a hole instead of swapping, using the spare entry at
+// index `capacity` as scratch.
+//
+// A heap given a limit with Heap_bound keeps at most `limit` items: once
+// full, an add replaces the top if the new item ranks below it and is
+// dropped otherwise, so the heap retains the `limit` lowest-ranked items
+// seen (e.g. the K nearest with a distance comparison).
 typedef struct Heap {
   size_t sizeOfKey;
   size_t sizeOfValue;
+  size_t keyOffset;
+  size_t valueOffset;
+  size_t sizeOfEntry;
   size_t capacity;
   size_t len;
-  HeapItem **table;
+  size_t limit;
+  char *entries;
   int (*compare_value)(const void *, const void *);
   void *(*copy_key)(const void *);
   void (*free_key)(void *);
@@ -22,120 +48,322 @@ typedef struct Heap {
   void (*free_value)(void *);
 } Heap;
 
-Heap *Heap_create(size_t sizeOfKey, size_t sizeOfValue,
-                  int (*compare_value)(const void *, const void *),
-                  void *(*copy_key)(const void *), void (*free_key)(void *),
-                  void *(*copy_value)(const void *),
-                  void (*free_value)(void *)) {
+static inline size_t Heap_align(size_t size) {
+  return (size + sizeof(int64_t) - 1) & ~(sizeof(int64_t) - 1);
+}
+
+static inline bool Heap_boxed_key(const Heap *heap) {
+  return heap->copy_key || heap->free_key;
+}
+
+static inline bool Heap_boxed_value(const Heap *heap) {
+  return heap->copy_value || heap->free_value;
+}
+
+static inline Heap *Heap_create_layout(size_t capacity, size_t sizeOfKey,
+    size_t sizeOfValue, int (*compare_value)(const void *, const void *),
+    void *(*copy_key)(const void *), void (*free_key)(void *),
+    void *(*copy_value)(const void *), void (*free_value)(void *)) {
   Heap *heap = malloc(sizeof(Heap));
   assert(heap);
   heap->sizeOfKey = sizeOfKey;
   heap->sizeOfValue = sizeOfValue;
-  heap->len = 0;
-  heap->capacity = 1000000;
-  heap->table = calloc(heap->capacity, sizeof(HeapItem *));
-  assert(compare_value);
   heap->compare_value = compare_value;
   heap->copy_key = copy_key;
   heap->free_key = free_key;
   heap->copy_value = copy_value;
   heap->free_value = free_value;
+  size_t sizeOfKeySlot = Heap_boxed_key(heap) ? sizeof(void *) : sizeOfKey;
+  size_t sizeOfValueSlot =
+      Heap_boxed_value(heap) ? sizeof(void *) : sizeOfValue;
+  heap->keyOffset = compare_value ? 0 : sizeof(int64_t);
+  heap->valueOffset = Heap_align(heap->keyOffset + sizeOfKeySlot);
+  heap->sizeOfEntry = Heap_align(heap->valueOffset + sizeOfValueSlot);
+  heap->len = 0;
+  heap->limit = 0;
+  heap->capacity = capacity ? capacity : 16;
+  heap->entries = malloc((heap->capacity + 1) * heap->sizeOfEntry);
+  assert(heap->entries);
   return heap;
 }
 
-void Heap_heapifyUp(Heap *heap, int index) {
-  int parent = (index - 1) / 2;
-  if (index <= 0) {
-    return;
-  }
-  if (heap->compare_value(heap->table[index]->value,
-                          heap->table[parent]->value) > 0) {
-    HeapItem *tmp = heap->table[index];
-    heap->table[index] = heap->table[parent];
-    heap->table[parent] = tmp;
-    Heap_heapifyUp(heap, parent);
-  }
+// `capacity` is a hint; the heap grows past it as needed.
+static inline Heap *Heap_create(size_t capacity, size_t sizeOfKey,
+    size_t sizeOfValue, int (*compare_value)(const void *, const void *),
+    void *(*copy_key)(const void *), void (*free_key)(void *),
+    void *(*copy_value)(const void *), void (*free_value)(void *)) {
+  assert(compare_value);
+  return Heap_create_layout(capacity, sizeOfKey, sizeOfValue, compare_value,
+                            copy_key, free_key, copy_value, free_value);
+}
+
+// Heap ordered by an integer priority given to Heap_add_priority.
+static inline Heap *Heap_create_priority(size_t capacity, size_t sizeOfKey,
+                                         size_t sizeOfValue) {
+  return Heap_create_layout(capacity, sizeOfKey, sizeOfValue, NULL, NULL,
+                            NULL, NULL, NULL);
+}
+
+static inline char *Heap_entry(const Heap *heap, size_t index) {
+  return heap->entries + index * heap->sizeOfEntry;
+}
+
+static inline int64_t Heap_priority_of(const char *entry) {
+  int64_t priority;
+  memcpy(&priority, entry, sizeof(priority));
+  return priority;
+}
+
+static inline void *Heap_key_of(const Heap *heap, char *entry) {
+  void *slot = entry + heap->keyOffset;
+  return Heap_boxed_key(heap) ? *(void **)slot : slot;
 }
 
-void Heap_heapifyDown(Heap *heap, int index) {
-  int leftChild = 2 * index + 1;
-  int rightChild = 2 * index + 2;
+static inline void *Heap_value_of(const Heap *heap, char *entry) {
+  void *slot = entry + heap->valueOffset;
+  return Heap_boxed_value(heap) ? *(void **)slot : slot;
+}
 
-  int max = index;
-  if (leftChild < heap->len &&
-      heap->compare_value(heap->table[leftChild]->value,
-                          heap->table[max]->value) > 0) {
-    max = leftChild;
+// Whether entry a belongs above entry b.
+static inline bool Heap_above(const Heap *heap, char *a, char *b) {
+  if (!heap->compare_value) {
+    return Heap_priority_of(a) > Heap_priority_of(b);
   }
-  if (rightChild < heap->len &&
-      heap->compare_value(heap->table[rightChild]->value,
-                          heap->table[max]->value) > 0) {
-    max = rightChild;
+  return heap->compare_value(Heap_value_of(heap, a), Heap_value_of(heap, b)) >
+         0;
+}
+
+// Moves the entry at `index` up to its place.
+static inline void Heap_sift_up(Heap *heap, size_t index) {
+  char *moving = Heap_entry(heap, heap->capacity);
+  memcpy(moving, Heap_entry(heap, index), heap->sizeOfEntry);
+  PROF_COUNT("heap.sift_up", 1);
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!Heap_above(heap, moving, Heap_entry(heap, parent))) {
+      break;
+    }
+    memcpy(Heap_entry(heap, index), Heap_entry(heap, parent),
+           heap->sizeOfEntry);
+    PROF_COUNT("heap.sift.level", 1);
+    index = parent;
   }
+  memcpy(Heap_entry(heap, index), moving, heap->sizeOfEntry);
+}
 
-  if (max != index) {
-    HeapItem *tmp = heap->table[index];
-    heap->table[index] = heap->table[max];
-    heap->table[max] = tmp;
-    Heap_heapifyDown(heap, max);
+// Moves the entry at `index` down to its place.
+static inline void Heap_sift_down(Heap *heap, size_t index) {
+  char *moving = Heap_entry(heap, heap->capacity);
+  memcpy(moving, Heap_entry(heap, index), heap->sizeOfEntry);
+  PROF_COUNT("heap.sift_down", 1);
+  while (true) {
+    size_t child = 2 * index + 1;
+    if (child >= heap->len) {
+      break;
+    }
+    if (child + 1 < heap->len && Heap_above(heap, Heap_entry(heap, child + 1),
+                                            Heap_entry(heap, child))) {
+      child++;
+    }
+    if (!Heap_above(heap, Heap_entry(heap, child), moving)) {
+      break;
+    }
+    memcpy(Heap_entry(heap, index), Heap_entry(heap, child),
+           heap->sizeOfEntry);
+    PROF_COUNT("heap.sift.level", 1);
+    index = child;
   }
+  memcpy(Heap_entry(heap, index), moving, heap->sizeOfEntry);
 }
 
-void Heap_add(Heap *heap, const void *key, const void *value) {
-  assert(heap);
+static inline void Heap_reserve(Heap *heap, size_t capacity) {
+  if (capacity <= heap->capacity) {
+    return;
+  }
+  heap->entries = realloc(heap->entries, (capacity + 1) * heap->sizeOfEntry);
+  assert(heap->entries);
+  heap->capacity = capacity;
+}
+
+// Appends a new entry with its key and value stored, without sifting. A
+// key or value of size 0 may be NULL.
+static inline char *Heap_push_entry(Heap *heap, const void *key,
+                                    const void *value) {
   if (heap->len == heap->capacity) {
-    size_t capacity = heap->capacity * 2;
-    HeapItem **table = calloc(capacity, sizeof(HeapItem *));
-    for (size_t i = 0; i < heap->len; i++) {
-      table[i] = heap->table[i];
-    }
-    free(heap->table);
-    heap->table = table;
-    heap->capacity = capacity;
+    Heap_reserve(heap, heap->capacity * 2);
   }
-  HeapItem *item = malloc(sizeof(HeapItem));
+  char *entry = Heap_entry(heap, heap->len++);
   if (heap->copy_key) {
-    item->key = heap->copy_key(key);
-  } else {
-    item->key = calloc(1, heap->sizeOfKey);
-    memcpy(item->key, key, heap->sizeOfKey);
+    *(void **)(entry + heap->keyOffset) = heap->copy_key(key);
+  } else if (heap->free_key) {
+    void *copy = malloc(heap->sizeOfKey);
+    if (key) {
+      memcpy(copy, key, heap->sizeOfKey);
+    }
+    *(void **)(entry + heap->keyOffset) = copy;
+  } else if (key) {
+    memcpy(entry + heap->keyOffset, key, heap->sizeOfKey);
   }
   if (heap->copy_value) {
-    item->value = heap->copy_value(value);
+    *(void **)(entry + heap->valueOffset) = heap->copy_value(value);
+  } else if (heap->free_value) {
+    void *copy = malloc(heap->sizeOfValue);
+    if (value) {
+      memcpy(copy, value, heap->sizeOfValue);
+    }
+    *(void **)(entry + heap->valueOffset) = copy;
+  } else if (value) {
+    memcpy(entry + heap->valueOffset, value, heap->sizeOfValue);
+  }
+  return entry;
+}
+
+static inline void Heap_release_key(const Heap *heap, char *entry) {
+  if (Heap_boxed_key(heap)) {
+    void *key = *(void **)(entry + heap->keyOffset);
+    heap->free_key ? heap->free_key(key) : free(key);
+  }
+}
+
+static inline void Heap_release_value(const Heap *heap, char *entry) {
+  if (Heap_boxed_value(heap)) {
+    void *value = *(void **)(entry + heap->valueOffset);
+    heap->free_value ? heap->free_value(value) : free(value);
+  }
+}
+
+// Orders the entry just appended at len - 1. In a full bounded heap it
+// either replaces the top or is dropped.
+static inline void Heap_place_last(Heap *heap) {
+  if (!heap->limit || heap->len <= heap->limit) {
+    Heap_sift_up(heap, heap->len - 1);
+    return;
+  }
+  char *top = Heap_entry(heap, 0);
+  char *last = Heap_entry(heap, --heap->len);
+  if (Heap_above(heap, top, last)) {
+    Heap_release_key(heap, top);
+    Heap_release_value(heap, top);
+    memcpy(top, last, heap->sizeOfEntry);
+    Heap_sift_down(heap, 0);
   } else {
-    item->value = calloc(1, heap->sizeOfValue);
-    memcpy(item->value, value, heap->sizeOfValue);
+    Heap_release_key(heap, last);
+    Heap_release_value(heap, last);
   }
-  heap->table[heap->len++] = item;
-  Heap_heapifyUp(heap, heap->len - 1);
 }
 
-HeapItem *Heap_pop(Heap *heap) {
-  assert(heap);
-  assert(heap->len);
-  HeapItem *root = heap->table[0];
-  heap->table[0] = heap->table[heap->len - 1];
+static inline void Heap_add(Heap *heap, const void *key, const void *value) {
+  assert(heap && heap->compare_value);
+  Heap_push_entry(heap, key, value);
+  Heap_place_last(heap);
+}
+
+static inline void Heap_add_priority(Heap *heap, int64_t priority,
+                                     const void *key, const void *value) {
+  assert(heap && !heap->compare_value);
+  char *entry = Heap_push_entry(heap, key, value);
+  memcpy(entry, &priority, sizeof(priority));
+  Heap_place_last(heap);
+}
+
+// Heap_append/Heap_append_priority store items without ordering them;
+// call Heap_build before the next add, peek or pop. Building n items this
+// way is O(n) instead of O(n log n) for n adds. Not for bounded heaps.
+static inline void Heap_append(Heap *heap, const void *key, const void *value) {
+  assert(heap && heap->compare_value && !heap->limit);
+  Heap_push_entry(heap, key, value);
+}
+
+static inline void Heap_append_priority(Heap *heap, int64_t priority,
+                                        const void *key, const void *value) {
+  assert(heap && !heap->compare_value && !heap->limit);
+  char *entry = Heap_push_entry(heap, key, value);
+  memcpy(entry, &priority, sizeof(priority));
+}
+
+// Floyd's heapify: sifts every internal node down, deepest first.
+static inline void Heap_build(Heap *heap) {
+  for (size_t i = heap->len / 2; i-- > 0;) {
+    Heap_sift_down(heap, i);
+  }
+}
+
+// Turns an empty heap into a bounded one keeping at most `limit` items.
+static inline void Heap_bound(Heap *heap, size_t limit) {
+  assert(heap && !heap->len && limit);
+  heap->limit = limit;
+  Heap_reserve(heap, limit + 1);
+}
+
+// Top item; the pointers are valid until the heap is next modified.
+static inline HeapItem Heap_peek(const Heap *heap) {
+  assert(heap && heap->len);
+  char *entry = Heap_entry(heap, 0);
+  return (HeapItem){Heap_key_of(heap, entry), Heap_value_of(heap, entry)};
+}
+
+static inline int64_t Heap_peek_priority(const Heap *heap) {
+  assert(heap && heap->len && !heap->compare_value);
+  return Heap_priority_of(Heap_entry(heap, 0));
+}
+
+// Removes the top item. Its key and value are copied to `key` and `value`
+// when they are not NULL; for boxed keys/values the owned pointer is
+// copied instead and the caller takes it over.
+static inline void Heap_pop(Heap *heap, void *key, void *value) {
+  assert(heap && heap->len);
+  char *top = Heap_entry(heap, 0);
+  size_t sizeOfKeySlot =
+      Heap_boxed_key(heap) ? sizeof(void *) : heap->sizeOfKey;
+  size_t sizeOfValueSlot =
+      Heap_boxed_value(heap) ? sizeof(void *) : heap->sizeOfValue;
+  if (key) {
+    memcpy(key, top + heap->keyOffset, sizeOfKeySlot);
+  } else {
+    Heap_release_key(heap, top);
+  }
+  if (value) {
+    memcpy(value, top + heap->valueOffset, sizeOfValueSlot);
+  } else {
+    Heap_release_value(heap, top);
+  }
   heap->len--;
-  Heap_heapifyDown(heap, 0);
-  return root;
-}
-
-void Heap_free(Heap *heap) {
-  for (size_t i = 0; i < heap->len; i++) {
-    if (heap->table[i]) {
-      if (heap->free_key) {
-        heap->free_key(heap->table[i]->key);
-      } else {
-        free(heap->table[i]->key);
-      }
-      if (heap->free_value) {
-        heap->free_value(heap->table[i]->value);
-      } else {
-        free(heap->table[i]->value);
-      }
-      free(heap->table[i]);
+  if (heap->len) {
+    memcpy(top, Heap_entry(heap, heap->len), heap->sizeOfEntry);
+    Heap_sift_down(heap, 0);
+  }
+}
+
+static inline void Heap_free(Heap *heap) {
+  if (Heap_boxed_key(heap) || Heap_boxed_value(heap)) {
+    for (size_t i = 0; i < heap->len; i++) {
+      Heap_release_key(heap, Heap_entry(heap, i));
+      Heap_release_value(heap, Heap_entry(heap, i));
     }
   }
-  free(heap->table);
+  free(heap->entries);
   free(heap);
-}
\ No newline at end of file
+}
+
+// Writes the (at most) k elements of `base` that compare smallest to
+// `out` in ascending order using a bounded heap: O(n log k) time and O(k)
+// space. Returns how many were written.
+static inline size_t Heap_select(const void *base, size_t n, size_t size,
+                                 size_t k,
+                                 int (*compare)(const void *, const void *),
+                                 void *out) {
+  if (!k) {
+    return 0;
+  }
+  Heap *heap = Heap_create(k + 1, 0, size, compare, 0, 0, 0, 0);
+  Heap_bound(heap, k);
+  for (size_t i = 0; i < n; i++) {
+    Heap_add(heap, base, (const char *)base + i * size);
+  }
+  size_t count = heap->len;
+  for (size_t i = count; i-- > 0;) {
+    Heap_pop(heap, NULL, (char *)out + i * size);
+  }
+  Heap_free(heap);
+  return count;
+}
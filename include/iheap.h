@@ -0,0 +1,213 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+
+// Indexed binary heap over integer handles (e.g. vertex numbers) with
+// int64_t priorities. pos[handle] tracks where each handle sits, so a
+// handle's priority can be changed or the handle removed in O(log n)
+// instead of pushing duplicates and skipping stale entries; the heap never
+// holds more than one entry per handle. A min-heap pops the smallest
+// priority first, a max-heap the largest. Handle arrays grow on demand.
+#define IHEAP_ABSENT SIZE_MAX
+
+typedef struct IHeap {
+  bool max;
+  size_t len;
+  size_t capacity;
+  size_t *heap;
+  size_t nhandles;
+  size_t *pos;
+  int64_t *priority;
+} IHeap;
+
+static inline IHeap *IHeap_create(size_t nhandles, bool max) {
+  IHeap *heap = malloc(sizeof(IHeap));
+  assert(heap);
+  heap->max = max;
+  heap->len = 0;
+  heap->capacity = nhandles ? nhandles : 16;
+  heap->nhandles = heap->capacity;
+  heap->heap = malloc(heap->capacity * sizeof(size_t));
+  heap->pos = malloc(heap->nhandles * sizeof(size_t));
+  heap->priority = malloc(heap->nhandles * sizeof(int64_t));
+  assert(heap->heap && heap->pos && heap->priority);
+  memset(heap->pos, 0xff, heap->nhandles * sizeof(size_t));
+  return heap;
+}
+
+static inline void IHeap_reserve_handles(IHeap *heap, size_t nhandles) {
+  if (nhandles <= heap->nhandles) {
+    return;
+  }
+  size_t size = heap->nhandles;
+  while (size < nhandles) {
+    size *= 2;
+  }
+  heap->pos = realloc(heap->pos, size * sizeof(size_t));
+  heap->priority = realloc(heap->priority, size * sizeof(int64_t));
+  assert(heap->pos && heap->priority);
+  memset(heap->pos + heap->nhandles, 0xff,
+         (size - heap->nhandles) * sizeof(size_t));
+  heap->nhandles = size;
+}
+
+static inline bool IHeap_contains(const IHeap *heap, size_t handle) {
+  return handle < heap->nhandles && heap->pos[handle] != IHEAP_ABSENT;
+}
+
+static inline int64_t IHeap_priority(const IHeap *heap, size_t handle) {
+  assert(IHeap_contains(heap, handle));
+  return heap->priority[handle];
+}
+
+// Whether priority a belongs above priority b.
+static inline bool IHeap_above(const IHeap *heap, int64_t a, int64_t b) {
+  return heap->max ? a > b : a < b;
+}
+
+static inline void IHeap_place(IHeap *heap, size_t index, size_t handle) {
+  heap->heap[index] = handle;
+  heap->pos[handle] = index;
+}
+
+static inline void IHeap_sift_up(IHeap *heap, size_t index) {
+  size_t handle = heap->heap[index];
+  int64_t priority = heap->priority[handle];
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!IHeap_above(heap, priority, heap->priority[heap->heap[parent]])) {
+      break;
+    }
+    IHeap_place(heap, index, heap->heap[parent]);
+    index = parent;
+  }
+  IHeap_place(heap, index, handle);
+}
+
+static inline void IHeap_sift_down(IHeap *heap, size_t index) {
+  size_t handle = heap->heap[index];
+  int64_t priority = heap->priority[handle];
+  while (true) {
+    size_t child = 2 * index + 1;
+    if (child >= heap->len) {
+      break;
+    }
+    if (child + 1 < heap->len &&
+        IHeap_above(heap, heap->priority[heap->heap[child + 1]],
+                    heap->priority[heap->heap[child]])) {
+      child++;
+    }
+    if (!IHeap_above(heap, heap->priority[heap->heap[child]], priority)) {
+      break;
+    }
+    IHeap_place(heap, index, heap->heap[child]);
+    index = child;
+  }
+  IHeap_place(heap, index, handle);
+}
+
+static inline void IHeap_push(IHeap *heap, size_t handle, int64_t priority) {
+  IHeap_reserve_handles(heap, handle + 1);
+  assert(heap->pos[handle] == IHEAP_ABSENT);
+  if (heap->len == heap->capacity) {
+    heap->capacity *= 2;
+    heap->heap = realloc(heap->heap, heap->capacity * sizeof(size_t));
+    assert(heap->heap);
+  }
+  heap->priority[handle] = priority;
+  IHeap_place(heap, heap->len++, handle);
+  IHeap_sift_up(heap, heap->len - 1);
+}
+
+// Sets the priority of a queued handle and restores the heap order.
+static inline void IHeap_update(IHeap *heap, size_t handle, int64_t priority) {
+  assert(IHeap_contains(heap, handle));
+  int64_t old = heap->priority[handle];
+  heap->priority[handle] = priority;
+  if (IHeap_above(heap, priority, old)) {
+    IHeap_sift_up(heap, heap->pos[handle]);
+  } else {
+    IHeap_sift_down(heap, heap->pos[handle]);
+  }
+}
+
+static inline void IHeap_decrease_key(IHeap *heap, size_t handle,
+                                      int64_t priority) {
+  assert(priority <= IHeap_priority(heap, handle));
+  IHeap_update(heap, handle, priority);
+}
+
+static inline void IHeap_increase_key(IHeap *heap, size_t handle,
+                                      int64_t priority) {
+  assert(priority >= IHeap_priority(heap, handle));
+  IHeap_update(heap, handle, priority);
+}
+
+// Pushes `handle` or, if it is queued already, moves it to `priority` when
+// that ranks higher (the relaxation step of Dijkstra/A*). Returns whether
+// anything changed.
+static inline bool IHeap_push_or_improve(IHeap *heap, size_t handle,
+                                         int64_t priority) {
+  if (!IHeap_contains(heap, handle)) {
+    IHeap_push(heap, handle, priority);
+    return true;
+  }
+  if (!IHeap_above(heap, priority, heap->priority[handle])) {
+    return false;
+  }
+  IHeap_update(heap, handle, priority);
+  return true;
+}
+
+static inline void IHeap_remove(IHeap *heap, size_t handle) {
+  assert(IHeap_contains(heap, handle));
+  size_t index = heap->pos[handle];
+  heap->pos[handle] = IHEAP_ABSENT;
+  heap->len--;
+  if (index == heap->len) {
+    return;
+  }
+  size_t last = heap->heap[heap->len];
+  IHeap_place(heap, index, last);
+  if (IHeap_above(heap, heap->priority[last], heap->priority[handle])) {
+    IHeap_sift_up(heap, index);
+  } else {
+    IHeap_sift_down(heap, index);
+  }
+}
+
+static inline size_t IHeap_peek(const IHeap *heap) {
+  assert(heap->len);
+  return heap->heap[0];
+}
+
+// Removes and returns the top handle, storing its priority in `priority`
+// unless it is NULL.
+static inline size_t IHeap_pop(IHeap *heap, int64_t *priority) {
+  size_t handle = IHeap_peek(heap);
+  if (priority) {
+    *priority = heap->priority[handle];
+  }
+  IHeap_remove(heap, handle);
+  return handle;
+}
+
+static inline void IHeap_clear(IHeap *heap) {
+  for (size_t i = 0; i < heap->len; i++) {
+    heap->pos[heap->heap[i]] = IHEAP_ABSENT;
+  }
+  heap->len = 0;
+}
+
+static inline void IHeap_free(void *heap_void) {
+  IHeap *heap = (IHeap *)heap_void;
+  free(heap->heap);
+  free(heap->pos);
+  free(heap->priority);
+  free(heap);
+}
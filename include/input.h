@@ -0,0 +1,134 @@
+#pragma once
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "prof.h"
+
+// Whole-file input shared by the days. Regular files are mapped with
+// MAP_PRIVATE, so the bytes can be edited in place (copy-on-write) without
+// touching the file; pipes, and files whose size is an exact multiple of
+// the page size, are read into a buffer instead. Either way data[len] is
+// '\0', so strtol-style parsing can run off the end safely.
+//
+// lines[j] is the offset of line j and lines[nlines] is one past the end of
+// the last line's newline, so line j spans lines[j + 1] - lines[j] - 1
+// bytes. A trailing newline does not start an extra line. nx is the length
+// of the first line and ny the number of lines, which for a grid input
+// makes `char (*grid)[nx + 1] = (void *)input->data` index grid[j][i].
+typedef struct Input {
+  char *data;
+  size_t len;
+  size_t nlines;
+  size_t *lines;
+  int nx;
+  int ny;
+  bool mapped;
+} Input;
+
+// Reads all of `fd` into a malloc'd buffer with a spare byte at the end.
+// `hint` is the expected size, or 0 when unknown.
+static inline char *Input_read(int fd, size_t hint, size_t *len) {
+  size_t capacity = hint ? hint + 1 : 1 << 16;
+  char *data = malloc(capacity);
+  assert(data);
+  *len = 0;
+  while (true) {
+    if (*len + 1 == capacity) {
+      capacity *= 2;
+      data = realloc(data, capacity);
+      assert(data);
+    }
+    ssize_t n = read(fd, data + *len, capacity - 1 - *len);
+    if (n <= 0) {
+      assert(n == 0);
+      return data;
+    }
+    *len += n;
+  }
+}
+
+static inline void Input_index(Input *input) {
+  size_t capacity = 1024;
+  input->lines = malloc(capacity * sizeof(size_t));
+  assert(input->lines);
+  input->nlines = 0;
+  size_t offset = 0;
+  while (offset < input->len) {
+    if (input->nlines + 1 == capacity) {
+      capacity *= 2;
+      input->lines = realloc(input->lines, capacity * sizeof(size_t));
+      assert(input->lines);
+    }
+    input->lines[input->nlines++] = offset;
+    const char *newline =
+        memchr(input->data + offset, '\n', input->len - offset);
+    offset = newline ? (size_t)(newline - input->data) + 1 : input->len + 1;
+  }
+  input->lines[input->nlines] = offset;
+  input->ny = input->nlines;
+  input->nx = input->nlines ? input->lines[1] - input->lines[0] - 1 : 0;
+}
+
+// Loads `path`, or standard input when `path` is NULL or "-". Exits with a
+// message if the file cannot be opened.
+static inline Input *Input_open(const char *path) {
+  Input *input = calloc(1, sizeof(Input));
+  assert(input);
+  int fd = STDIN_FILENO;
+  if (path && strcmp(path, "-") != 0) {
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      perror(path);
+      exit(EXIT_FAILURE);
+    }
+  }
+  struct stat st;
+  bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+  long page = sysconf(_SC_PAGESIZE);
+  if (regular && st.st_size > 0 && st.st_size % page != 0) {
+    // the rest of the last page reads as zeros, which terminates the data
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0);
+    if (data != MAP_FAILED) {
+      input->data = data;
+      input->len = st.st_size;
+      input->mapped = true;
+    }
+  }
+  if (!input->mapped) {
+    input->data = Input_read(fd, regular ? st.st_size : 0, &input->len);
+  }
+  input->data[input->len] = '\0';
+  if (fd != STDIN_FILENO) {
+    close(fd);
+  }
+  Input_index(input);
+  return input;
+}
+
+static inline char *Input_line(const Input *input, size_t j) {
+  assert(j < input->nlines);
+  return input->data + input->lines[j];
+}
+
+static inline size_t Input_line_len(const Input *input, size_t j) {
+  assert(j < input->nlines);
+  return input->lines[j + 1] - input->lines[j] - 1;
+}
+
+static inline void Input_free(Input *input) {
+  if (input->mapped) {
+    munmap(input->data, input->len);
+  } else {
+    free(input->data);
+  }
+  free(input->lines);
+  free(input);
+}
@@ -1,9 +1,11 @@
+#pragma once
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "hash.h"
 
 typedef struct ListItem {
@@ -20,11 +22,15 @@ typedef struct List {
     bool (*compare_data)(const void*, const void*);
     void* (*copy_data)(const void*);
     void (*free_data)(void*);
+    Allocator* allocator;
 } List;
 
-List* List_create(size_t sizeOfData,
-                  bool (*compare_data)(const void*, const void*),
-                  void* (*copy_data)(const void*), void (*free_data)(void*)) {
+// Nodes, and element copies when copy_data is NULL, come from `allocator`
+// (NULL for malloc).
+static inline List* List_create_with(size_t sizeOfData,
+    bool (*compare_data)(const void*, const void*),
+    void* (*copy_data)(const void*), void (*free_data)(void*),
+    Allocator* allocator) {
     List* list = malloc(sizeof(List));
     list->head = NULL;
     list->tail = NULL;
@@ -33,17 +39,34 @@ List* List_create(size_t sizeOfData,
     list->compare_data = compare_data;
     list->copy_data = copy_data;
     list->free_data = free_data;
+    list->allocator = allocator;
     return list;
 }
 
-void List_append(List* list, void* data) {
+static inline List* List_create(size_t sizeOfData,
+                                bool (*compare_data)(const void*, const void*),
+                                void* (*copy_data)(const void*),
+                                void (*free_data)(void*)) {
+    return List_create_with(sizeOfData, compare_data, copy_data, free_data,
+                            NULL);
+}
+
+static inline void List_free_node(List* list, ListItem* item) {
+    if (list->free_data) {
+        list->free_data(item->data);
+    } else {
+        Allocator_free(list->allocator, item->data, list->sizeOfData);
+    }
+    Allocator_free(list->allocator, item, sizeof(ListItem));
+}
+
+static inline void List_append(List* list, void* data) {
     assert(list && data);
-    ListItem* item = calloc(1, sizeof(ListItem));
+    ListItem* item = Allocator_calloc(list->allocator, sizeof(ListItem));
     if (list->copy_data) {
         item->data = list->copy_data(data);
     } else {
-        item->data = calloc(1, list->sizeOfData);
-        memcpy(item->data, data, list->sizeOfData);
+        item->data = Allocator_copy(list->allocator, data, list->sizeOfData);
     }
     item->next = NULL;
     item->prev = list->tail;
@@ -58,7 +81,7 @@ void List_append(List* list, void* data) {
     list->len++;
 }
 
-ListItem* List_get_item(const List* list, int index) {
+static inline ListItem* List_get_item(const List* list, int index) {
     assert(list);
     if (index >= 0) {
         assert(index < list->len);
@@ -85,18 +108,28 @@ ListItem* List_get_item(const List* list, int index) {
     }
 }
 
-void* List_get(const List* list, int index) {
+static inline void* List_get(const List* list, int index) {
     ListItem* item = List_get_item(list, index);
     return item->data;
 }
 
-void* List_return(const void* src) { return src; }
+// Allocation-free iteration: start with `ListItem* cursor = NULL` and call
+// until it returns NULL. A cursor pointing at an item resumes after it.
+static inline void* List_iter_next(const List* list, ListItem** cursor) {
+    assert(list && cursor);
+    *cursor = *cursor ? (*cursor)->next : list->head;
+    return *cursor ? (*cursor)->data : NULL;
+}
+
+static inline void* List_return(const void* src) { return src; }
 
-void* List_copy(const void* src) {
+static inline void* List_copy(const void* src) {
     assert(src);
     List* srcList = (List*)src;
-    List* destList = List_create(srcList->sizeOfData, srcList->compare_data,
-                                 srcList->copy_data, srcList->free_data);
+    List* destList =
+        List_create_with(srcList->sizeOfData, srcList->compare_data,
+                         srcList->copy_data, srcList->free_data,
+                         srcList->allocator);
     ListItem* item = srcList->head;
     while (item) {
         List_append(destList, item->data);
@@ -105,18 +138,16 @@ void* List_copy(const void* src) {
     return destList;
 }
 
-void List_free(void* list_void) {
+static inline void List_free(void* list_void) {
     assert(list_void);
     List* list = (List*)list_void;
-    ListItem* current = list->head;
+    // nodes from an arena go away with the arena
+    ListItem* current = list->free_data || Allocator_frees(list->allocator)
+                            ? list->head
+                            : NULL;
     while (current) {
         ListItem* next = current->next;
-        if (list->free_data) {
-            list->free_data(current->data);
-        } else {
-            free(current->data);
-        }
-        free(current);
+        List_free_node(list, current);
         current = next;
     }
     list->head = NULL;
@@ -125,7 +156,7 @@ void List_free(void* list_void) {
     free(list);
 }
 
-void* List_pop(List* list, int index) {
+static inline void* List_pop(List* list, int index) {
     ListItem* current = List_get_item(list, index);
     ListItem* prev = current->prev;
     ListItem* next = current->next;
@@ -146,17 +177,12 @@ void* List_pop(List* list, int index) {
         res = calloc(1, list->sizeOfData);
         memcpy(res, current->data, list->sizeOfData);
     }
-    if (list->free_data) {
-        list->free_data(current->data);
-    } else {
-        free(current->data);
-    }
-    free(current);
+    List_free_node(list, current);
     list->len--;
     return res;
 }
 
-bool List_find(const List* list, const void* data) {
+static inline bool List_find(const List* list, const void* data) {
     assert(list);
     ListItem* item = list->head;
     if (list->compare_data) {
@@ -174,7 +200,8 @@ bool List_find(const List* list, const void* data) {
     return false;
 }
 
-bool List_compare(const void* list_void1, const void* list_void2) {
+static inline bool List_compare(const void* list_void1,
+                                const void* list_void2) {
     const List* list1 = (const List*)list_void1;
     const List* list2 = (const List*)list_void2;
     assert(list1->len == list2->len);
@@ -196,7 +223,7 @@ bool List_compare(const void* list_void1, const void* list_void2) {
     return true;
 }
 
-void** List_items(const List* list) {
+static inline void** List_items(const List* list) {
     assert(list);
     void** list_items = malloc(list->len * sizeof(void*));
     ListItem* item = list->head;
@@ -0,0 +1,118 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Integer and record parsing straight from an in-memory buffer (see
+// input.h). Every parser takes the current position and the end of the
+// buffer and returns the position after what it consumed, or NULL when
+// the text does not match; nothing is read at or past `end`. Decimal
+// digits are converted eight at a time with SWAR when eight bytes remain.
+
+#define PARSE_ONES 0x0101010101010101ULL
+
+// Number of leading decimal digits in the 8 bytes of `v` (first byte in
+// the lowest bits), 0-8.
+static inline int parse_digit_count(uint64_t v) {
+  // a byte is a digit iff its high nibble is 3 and its low nibble is <= 9;
+  // neither test carries across bytes
+  uint64_t bad = ((v & 0xF0 * PARSE_ONES) ^ 0x30 * PARSE_ONES) |
+                 (((v & 0x0F * PARSE_ONES) + 0x06 * PARSE_ONES) &
+                  0xF0 * PARSE_ONES);
+  uint64_t nonzero =
+      (((bad & 0x7F * PARSE_ONES) + 0x7F * PARSE_ONES) | bad) &
+      0x80 * PARSE_ONES;
+  return nonzero ? __builtin_ctzll(nonzero) >> 3 : 8;
+}
+
+// Value of the 8 digit bytes in `v` after masking to their low nibbles.
+static inline uint64_t parse_eight_digits(uint64_t v) {
+  v = v * 10 + (v >> 8);
+  return (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+          (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+         32;
+}
+
+static inline const char *parse_uint(const char *p, const char *end,
+                                     unsigned long *out) {
+  static const uint64_t pow10[9] = {1,      10,      100,      1000,     10000,
+                                    100000, 1000000, 10000000, 100000000};
+  unsigned long value = 0;
+  const char *start = p;
+  while (end - p >= 8) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    int n = parse_digit_count(v);
+    if (n) {
+      uint64_t digits = (v & 0x0F * PARSE_ONES) << (8 * (8 - n));
+      value = value * pow10[n] + parse_eight_digits(digits);
+      p += n;
+    }
+    if (n < 8) {
+      *out = value;
+      return p == start ? NULL : p;
+    }
+  }
+  while (p < end && (unsigned char)(*p - '0') < 10) {
+    value = value * 10 + (*p++ - '0');
+  }
+  *out = value;
+  return p == start ? NULL : p;
+}
+
+// Optional '-' or '+' followed by digits.
+static inline const char *parse_int(const char *p, const char *end, long *out) {
+  bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  unsigned long value;
+  p = parse_uint(p, end, &value);
+  *out = negative ? -(long)value : (long)value;
+  return p;
+}
+
+// Consumes `c` if it comes next.
+static inline const char *parse_char(const char *p, const char *end, char c) {
+  return p < end && *p == c ? p + 1 : NULL;
+}
+
+// Skips spaces, tabs and line breaks.
+static inline const char *parse_skip_space(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+    p++;
+  }
+  return p;
+}
+
+// Word up to the next space, tab or line break. Its length is the
+// returned position minus `p`; an empty word does not match.
+static inline const char *parse_word(const char *p, const char *end) {
+  const char *start = p;
+  while (p < end && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+    p++;
+  }
+  return p == start ? NULL : p;
+}
+
+// Fixed-format record of `n` integers separated by `sep`, e.g.
+// "x,y,z\n" with sep ',' or "a-b\n" with sep '-', followed by an optional
+// line break. On a mismatch returns NULL and `out` is unspecified.
+static inline const char *parse_record(const char *p, const char *end, char sep,
+                                       long *out, int n) {
+  for (int i = 0; i < n; i++) {
+    if (i && !(p = parse_char(p, end, sep))) {
+      return NULL;
+    }
+    if (!(p = parse_int(p, end, &out[i]))) {
+      return NULL;
+    }
+  }
+  if (p < end && *p == '\r') {
+    p++;
+  }
+  if (p < end && *p == '\n') {
+    p++;
+  }
+  return p;
+}
@@ -0,0 +1,434 @@
+#pragma once
+
+// Lightweight instrumentation, compiled in with -DPROF and to nothing
+// otherwise:
+//
+//   PROF_PHASE("parse")      ends the running phase and starts "parse"
+//   PROF_PHASE_END()         ends the running phase
+//   PROF_SCOPE("dfs")        times the rest of the enclosing block
+//   PROF_COUNT("dict.probe", n)  adds n to a named counter
+//   PROF_REPORT(file)        prints and clears everything recorded
+//
+// Phases and scopes accumulate calls and nanoseconds (CLOCK_MONOTONIC)
+// under their name; counters only a sum. Entries with the same name
+// merge, and the report lists them in order of first use. The state is
+// per thread, so days solved concurrently by the aoc runner keep separate
+// reports; it is shared by all translation units of a binary.
+//
+// -DPROF_PERF (which implies PROF) also counts cycles, instructions, cache
+// misses and branch misses of the calling thread over every phase with
+// Linux perf_event_open. Counters the kernel refuses, for instance under
+// perf_event_paranoid > 2 or in a VM without a PMU, show as "-" and the
+// report says why; timing is unaffected.
+//
+// -DPROF_ALLOC (which implies PROF) redirects malloc, calloc, realloc and
+// free in every file that includes this header, which all allocating
+// headers in include/ do, and reports per phase the allocations, frees and
+// bytes requested, the peak of live bytes and the peak RSS of the process
+// so far. Live bytes are measured with malloc_usable_size, so blocks from
+// elsewhere (libc, GLPK) freed here lower them; the report ends with what
+// is still live, which for a finished day is what it leaked. Arena and
+// Pool serve many allocations from one malloc, so they add counters
+// through PROF_ALLOC_COUNT instead: calls are allocations or blocks and
+// the total is bytes.
+
+#if (defined(PROF_PERF) || defined(PROF_ALLOC)) && !defined(PROF)
+#define PROF
+#endif
+
+#ifdef PROF
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef PROF_PERF
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef PROF_ALLOC
+#include <malloc.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#endif
+
+#define PROF_ENTRIES 64
+#define PROF_SLOTS 256
+
+#ifdef PROF_PERF
+#define PROF_EVENTS 4
+#endif
+
+typedef enum { PROF_TIMER, PROF_COUNTER } ProfKind;
+
+typedef struct ProfEntry {
+  const char *name;
+  ProfKind kind;
+  uint64_t calls;
+  uint64_t total;
+#ifdef PROF_PERF
+  // hardware events over the phases of this name; scopes leave them zero
+  bool counted;
+  uint64_t events[PROF_EVENTS];
+#endif
+#ifdef PROF_ALLOC
+  bool tracked;
+  uint64_t allocs;
+  uint64_t frees;
+  uint64_t bytes;
+  int64_t peakLive;
+  long peakRss;
+#endif
+} ProfEntry;
+
+// Entries are found by the address of their name through a small
+// open-addressing table, so a counter costs a hash and a compare; a new
+// address falls back to comparing names.
+typedef struct ProfState {
+  int len;
+  ProfEntry entries[PROF_ENTRIES];
+  const char *keys[PROF_SLOTS];
+  int index[PROF_SLOTS];
+  const char *phase;
+  uint64_t phaseStart;
+#ifdef PROF_PERF
+  // opened on the first phase of the thread; -1 where the kernel refused
+  bool perfOpened;
+  int perfFd[PROF_EVENTS];
+  int perfErrno;
+  uint64_t phaseEvents[PROF_EVENTS];
+#endif
+#ifdef PROF_ALLOC
+  // running totals of the thread, and the first three at the phase start
+  uint64_t allocs;
+  uint64_t frees;
+  uint64_t bytes;
+  int64_t live;
+  int64_t liveBlocks;
+  uint64_t phaseAllocs;
+  uint64_t phaseFrees;
+  uint64_t phaseBytes;
+  int64_t phasePeak;
+#endif
+} ProfState;
+
+__attribute__((weak)) _Thread_local ProfState prof_state;
+
+static inline uint64_t prof_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#ifdef PROF_PERF
+static const char *const prof_event_names[PROF_EVENTS] = {
+    "cycles", "instructions", "cache-miss", "branch-miss"};
+static const uint64_t prof_event_configs[PROF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+// Each event is a separate counter of the calling thread in user space, so
+// one that is unsupported does not take the others down with it.
+static inline void prof_perf_open(ProfState *state) {
+  state->perfOpened = true;
+  for (int i = 0; i < PROF_EVENTS; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = prof_event_configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    state->perfFd[i] =
+        syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (state->perfFd[i] < 0) {
+      state->perfFd[i] = -1;
+      state->perfErrno = errno;
+    }
+  }
+}
+
+static inline void prof_perf_read(ProfState *state, uint64_t *values) {
+  for (int i = 0; i < PROF_EVENTS; i++) {
+    values[i] = 0;
+    if (state->perfFd[i] >= 0 &&
+        read(state->perfFd[i], &values[i], sizeof(values[i])) !=
+            sizeof(values[i])) {
+      values[i] = 0;
+    }
+  }
+}
+
+static inline void prof_perf_close(ProfState *state) {
+  for (int i = 0; state->perfOpened && i < PROF_EVENTS; i++) {
+    if (state->perfFd[i] >= 0) {
+      close(state->perfFd[i]);
+    }
+  }
+}
+#endif
+
+static inline ProfEntry *prof_entry(const char *name, ProfKind kind) {
+  ProfState *state = &prof_state;
+  size_t slot = ((uintptr_t)name >> 3) * 0x9E3779B97F4A7C15ULL >> 56;
+  size_t probes = 0;
+  while (state->keys[slot] && state->keys[slot] != name &&
+         probes < PROF_SLOTS) {
+    slot = (slot + 1) % PROF_SLOTS;
+    probes++;
+  }
+  // a full table leaves the name uncached and falls back to the slow lookup
+  bool cached = probes < PROF_SLOTS;
+  if (cached && state->keys[slot]) {
+    return &state->entries[state->index[slot]];
+  }
+  int i = 0;
+  while (i < state->len && strcmp(state->entries[i].name, name) != 0) {
+    i++;
+  }
+  if (i == state->len) {
+    if (state->len == PROF_ENTRIES) {
+      // out of room: later names share the last entry
+      i = PROF_ENTRIES - 1;
+    } else {
+      state->entries[state->len++] = (ProfEntry){name, kind, 0, 0};
+    }
+  }
+  if (cached) {
+    state->keys[slot] = name;
+    state->index[slot] = i;
+  }
+  return &state->entries[i];
+}
+
+static inline void prof_count(const char *name, uint64_t n) {
+  ProfEntry *entry = prof_entry(name, PROF_COUNTER);
+  entry->calls++;
+  entry->total += n;
+}
+
+static inline void prof_time(const char *name, uint64_t ns) {
+  ProfEntry *entry = prof_entry(name, PROF_TIMER);
+  entry->calls++;
+  entry->total += ns;
+}
+
+static inline void prof_phase_end(void) {
+  ProfState *state = &prof_state;
+  if (state->phase) {
+    uint64_t end = prof_now();
+#ifdef PROF_PERF
+    uint64_t events[PROF_EVENTS];
+    prof_perf_read(state, events);
+    ProfEntry *entry = prof_entry(state->phase, PROF_TIMER);
+    entry->counted = true;
+    for (int i = 0; i < PROF_EVENTS; i++) {
+      entry->events[i] += events[i] - state->phaseEvents[i];
+    }
+#endif
+#ifdef PROF_ALLOC
+    ProfEntry *allocEntry = prof_entry(state->phase, PROF_TIMER);
+    allocEntry->tracked = true;
+    allocEntry->allocs += state->allocs - state->phaseAllocs;
+    allocEntry->frees += state->frees - state->phaseFrees;
+    allocEntry->bytes += state->bytes - state->phaseBytes;
+    if (state->phasePeak > allocEntry->peakLive) {
+      allocEntry->peakLive = state->phasePeak;
+    }
+    struct rusage usage;
+    // ru_maxrss is the high-water mark of the process, in kilobytes
+    if (getrusage(RUSAGE_SELF, &usage) == 0 &&
+        usage.ru_maxrss > allocEntry->peakRss) {
+      allocEntry->peakRss = usage.ru_maxrss;
+    }
+#endif
+    prof_time(state->phase, end - state->phaseStart);
+    state->phase = NULL;
+  }
+}
+
+static inline void prof_phase(const char *name) {
+  prof_phase_end();
+  // registered before the clock starts so lookup is not timed
+  prof_entry(name, PROF_TIMER);
+  prof_state.phase = name;
+#ifdef PROF_PERF
+  if (!prof_state.perfOpened) {
+    prof_perf_open(&prof_state);
+  }
+  prof_perf_read(&prof_state, prof_state.phaseEvents);
+#endif
+#ifdef PROF_ALLOC
+  prof_state.phaseAllocs = prof_state.allocs;
+  prof_state.phaseFrees = prof_state.frees;
+  prof_state.phaseBytes = prof_state.bytes;
+  prof_state.phasePeak = prof_state.live;
+#endif
+  prof_state.phaseStart = prof_now();
+}
+
+typedef struct ProfScope {
+  const char *name;
+  uint64_t start;
+} ProfScope;
+
+static inline void prof_scope_end(ProfScope *scope) {
+  prof_time(scope->name, prof_now() - scope->start);
+}
+
+static inline void prof_report(FILE *file) {
+  ProfState *state = &prof_state;
+  prof_phase_end();
+#ifdef PROF_PERF
+  if (state->perfErrno) {
+    fprintf(file, "perf_event_open: %s\n", strerror(state->perfErrno));
+  }
+#endif
+  fprintf(file, "%-24s %12s %12s", "timer", "calls", "ms");
+#ifdef PROF_PERF
+  for (int i = 0; i < PROF_EVENTS; i++) {
+    fprintf(file, " %14s", prof_event_names[i]);
+  }
+  fprintf(file, " %6s", "ipc");
+#endif
+  fprintf(file, "\n");
+  for (int i = 0; i < state->len; i++) {
+    ProfEntry *entry = &state->entries[i];
+    if (entry->kind != PROF_TIMER) {
+      continue;
+    }
+    fprintf(file, "%-24s %12lu %12.3f", entry->name,
+            (unsigned long)entry->calls, entry->total * 1e-6);
+#ifdef PROF_PERF
+    for (int j = 0; j < PROF_EVENTS; j++) {
+      if (entry->counted && state->perfFd[j] >= 0) {
+        fprintf(file, " %14lu", (unsigned long)entry->events[j]);
+      } else {
+        fprintf(file, " %14s", "-");
+      }
+    }
+    // cycles and instructions come first
+    if (entry->counted && state->perfFd[1] >= 0 && entry->events[0]) {
+      fprintf(file, " %6.2f", (double)entry->events[1] / entry->events[0]);
+    } else {
+      fprintf(file, " %6s", "-");
+    }
+#endif
+    fprintf(file, "\n");
+  }
+#ifdef PROF_ALLOC
+  fprintf(file, "%-24s %12s %12s %12s %12s %12s\n", "allocation", "allocs",
+          "frees", "MB", "peak live MB", "peak rss MB");
+  for (int i = 0; i < state->len; i++) {
+    ProfEntry *entry = &state->entries[i];
+    if (entry->tracked) {
+      fprintf(file, "%-24s %12lu %12lu %12.3f %12.3f %12.3f\n", entry->name,
+              (unsigned long)entry->allocs, (unsigned long)entry->frees,
+              entry->bytes / 1048576.0, entry->peakLive / 1048576.0,
+              entry->peakRss / 1024.0);
+    }
+  }
+  fprintf(file, "live at report: %ld bytes in %ld blocks\n",
+          (long)state->live, (long)state->liveBlocks);
+#endif
+  fprintf(file, "%-24s %12s %12s\n", "counter", "calls", "total");
+  for (int i = 0; i < state->len; i++) {
+    ProfEntry *entry = &state->entries[i];
+    if (entry->kind == PROF_COUNTER) {
+      fprintf(file, "%-24s %12lu %12lu\n", entry->name,
+              (unsigned long)entry->calls, (unsigned long)entry->total);
+    }
+  }
+#ifdef PROF_PERF
+  prof_perf_close(state);
+#endif
+  memset(state, 0, sizeof(*state));
+}
+
+#ifdef PROF_ALLOC
+static inline void prof_allocated(void *ptr, size_t size) {
+  ProfState *state = &prof_state;
+  state->allocs++;
+  state->bytes += size;
+  state->live += malloc_usable_size(ptr);
+  state->liveBlocks++;
+  if (state->phase && state->live > state->phasePeak) {
+    state->phasePeak = state->live;
+  }
+}
+
+static inline void prof_freed(void *ptr) {
+  prof_state.frees++;
+  prof_state.live -= malloc_usable_size(ptr);
+  prof_state.liveBlocks--;
+}
+
+static inline void *prof_malloc(size_t size) {
+  void *ptr = malloc(size);
+  if (ptr) {
+    prof_allocated(ptr, size);
+  }
+  return ptr;
+}
+
+static inline void *prof_calloc(size_t count, size_t size) {
+  void *ptr = calloc(count, size);
+  if (ptr) {
+    prof_allocated(ptr, count * size);
+  }
+  return ptr;
+}
+
+// Counted as a free of the old block and an allocation of the new one.
+static inline void *prof_realloc(void *old, size_t size) {
+  if (old) {
+    prof_freed(old);
+  }
+  void *ptr = realloc(old, size);
+  if (ptr) {
+    prof_allocated(ptr, size);
+  }
+  return ptr;
+}
+
+static inline void prof_free(void *ptr) {
+  if (ptr) {
+    prof_freed(ptr);
+  }
+  free(ptr);
+}
+
+// Defined last so that the functions above reach the real ones.
+#define malloc(size) prof_malloc(size)
+#define calloc(count, size) prof_calloc(count, size)
+#define realloc(ptr, size) prof_realloc(ptr, size)
+#define free(ptr) prof_free(ptr)
+#endif
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_PHASE(name) prof_phase(name)
+#define PROF_PHASE_END() prof_phase_end()
+#define PROF_SCOPE(name)                                                       \
+  ProfScope PROF_CONCAT(prof_scope_, __LINE__)                                 \
+      __attribute__((cleanup(prof_scope_end))) = {name, prof_now()}
+#define PROF_COUNT(name, n) prof_count(name, n)
+#define PROF_REPORT(file) prof_report(file)
+#ifdef PROF_ALLOC
+#define PROF_ALLOC_COUNT(name, n) prof_count(name, n)
+#else
+#define PROF_ALLOC_COUNT(name, n) ((void)0)
+#endif
+
+#else
+
+#define PROF_PHASE(name) ((void)0)
+#define PROF_PHASE_END() ((void)0)
+#define PROF_SCOPE(name) ((void)0)
+#define PROF_COUNT(name, n) ((void)0)
+#define PROF_REPORT(file) ((void)0)
+#define PROF_ALLOC_COUNT(name, n) ((void)0)
+
+#endif
@@ -0,0 +1,235 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "hash.h"
+
+// Persistent (immutable) set: a hash array mapped trie with 32-way bitmap
+// nodes. PSet_add returns a new version and leaves its argument untouched;
+// the two share every node off the path to the new key, so an add costs
+// O(log32 n) node copies and PSet_copy is O(1). Nodes are reference
+// counted and freed when the last version using them is freed. Meant for
+// backtracking searches that carry a visited set down the recursion.
+// Nodes come from the allocator given to PSet_create_with (NULL for
+// malloc), which every version derived from that set shares.
+
+#define PSET_BITS 5
+#define PSET_FANOUT (1 << PSET_BITS)
+
+// An internal node has a non-zero bitmap and popcount(bitmap) children in
+// `data`, ordered by slot. A leaf has bitmap 0 and stores `count` keys
+// sharing the full 64-bit `hash` (count > 1 only on a complete collision).
+typedef struct PSetNode {
+  uint32_t refs;
+  uint32_t bitmap;
+  uint32_t count;
+  uint64_t hash;
+  unsigned char data[];
+} PSetNode;
+
+typedef struct PSet {
+  size_t sizeOfData;
+  size_t len;
+  PSetNode *root;
+  Allocator *allocator;
+} PSet;
+
+static inline PSetNode **PSet_children(const PSetNode *node) {
+  return (PSetNode **)node->data;
+}
+
+static inline PSetNode *PSet_retain(PSetNode *node) {
+  if (node) {
+    node->refs++;
+  }
+  return node;
+}
+
+static inline size_t PSet_node_size(const PSet *set, const PSetNode *node) {
+  if (node->bitmap) {
+    return sizeof(PSetNode) +
+           __builtin_popcount(node->bitmap) * sizeof(PSetNode *);
+  }
+  return sizeof(PSetNode) + node->count * set->sizeOfData;
+}
+
+static inline void PSet_release(const PSet *set, PSetNode *node) {
+  if (!node || --node->refs) {
+    return;
+  }
+  if (node->bitmap) {
+    int n = __builtin_popcount(node->bitmap);
+    for (int i = 0; i < n; i++) {
+      PSet_release(set, PSet_children(node)[i]);
+    }
+  }
+  Allocator_free(set->allocator, node, PSet_node_size(set, node));
+}
+
+static inline PSetNode *PSet_leaf(const PSet *set, uint64_t h,
+                                  const void *data) {
+  PSetNode *leaf =
+      Allocator_alloc(set->allocator, sizeof(PSetNode) + set->sizeOfData);
+  leaf->refs = 1;
+  leaf->bitmap = 0;
+  leaf->count = 1;
+  leaf->hash = h;
+  memcpy(leaf->data, data, set->sizeOfData);
+  return leaf;
+}
+
+static inline PSetNode *PSet_branch(const PSet *set, uint32_t bitmap) {
+  PSetNode *node = Allocator_alloc(
+      set->allocator,
+      sizeof(PSetNode) + __builtin_popcount(bitmap) * sizeof(PSetNode *));
+  node->refs = 1;
+  node->bitmap = bitmap;
+  node->count = 0;
+  node->hash = 0;
+  return node;
+}
+
+static inline size_t PSet_slot(const PSetNode *node, uint32_t bit) {
+  return __builtin_popcount(node->bitmap & (bit - 1));
+}
+
+static inline PSet *PSet_create_with(size_t sizeOfData, Allocator *allocator) {
+  PSet *set = malloc(sizeof(PSet));
+  assert(set);
+  set->sizeOfData = sizeOfData;
+  set->len = 0;
+  set->root = NULL;
+  set->allocator = allocator;
+  return set;
+}
+
+static inline PSet *PSet_create(size_t sizeOfData) {
+  return PSet_create_with(sizeOfData, NULL);
+}
+
+static inline bool PSet_find(const PSet *set, const void *data) {
+  uint64_t h = hash(data, set->sizeOfData, HASH_SEED);
+  const PSetNode *node = set->root;
+  for (int shift = 0; node && node->bitmap; shift += PSET_BITS) {
+    uint32_t bit = 1u << ((h >> shift) & (PSET_FANOUT - 1));
+    if (!(node->bitmap & bit)) {
+      return false;
+    }
+    node = PSet_children(node)[PSet_slot(node, bit)];
+  }
+  if (!node || node->hash != h) {
+    return false;
+  }
+  for (uint32_t i = 0; i < node->count; i++) {
+    if (memcmp(node->data + i * set->sizeOfData, data, set->sizeOfData) ==
+        0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Builds the smallest subtree holding two leaves with different hashes,
+// taking over the caller's references to both.
+static inline PSetNode *PSet_join(const PSet *set, PSetNode *a, PSetNode *b,
+                                  int shift) {
+  uint32_t bit_a = 1u << ((a->hash >> shift) & (PSET_FANOUT - 1));
+  uint32_t bit_b = 1u << ((b->hash >> shift) & (PSET_FANOUT - 1));
+  if (bit_a == bit_b) {
+    PSetNode *node = PSet_branch(set, bit_a);
+    PSet_children(node)[0] = PSet_join(set, a, b, shift + PSET_BITS);
+    return node;
+  }
+  PSetNode *node = PSet_branch(set, bit_a | bit_b);
+  PSet_children(node)[bit_a < bit_b ? 0 : 1] = a;
+  PSet_children(node)[bit_a < bit_b ? 1 : 0] = b;
+  return node;
+}
+
+// Returns a new node for `node` with `data` added, or NULL if `data` is
+// already present. Untouched children are shared with `node`.
+static inline PSetNode *PSet_insert(const PSet *set, const PSetNode *node,
+                                    const void *data, uint64_t h, int shift) {
+  size_t sizeOfData = set->sizeOfData;
+  if (!node) {
+    return PSet_leaf(set, h, data);
+  }
+  if (!node->bitmap) {
+    if (node->hash != h) {
+      return PSet_join(set, PSet_retain((PSetNode *)node),
+                       PSet_leaf(set, h, data), shift);
+    }
+    for (uint32_t i = 0; i < node->count; i++) {
+      if (memcmp(node->data + i * sizeOfData, data, sizeOfData) == 0) {
+        return NULL;
+      }
+    }
+    PSetNode *leaf = Allocator_alloc(
+        set->allocator, sizeof(PSetNode) + (node->count + 1) * sizeOfData);
+    *leaf = *node;
+    leaf->refs = 1;
+    leaf->count++;
+    memcpy(leaf->data, node->data, node->count * sizeOfData);
+    memcpy(leaf->data + node->count * sizeOfData, data, sizeOfData);
+    return leaf;
+  }
+
+  uint32_t bit = 1u << ((h >> shift) & (PSET_FANOUT - 1));
+  size_t slot = PSet_slot(node, bit);
+  size_t n = __builtin_popcount(node->bitmap);
+  PSetNode *child = NULL;
+  if (node->bitmap & bit) {
+    child = PSet_insert(set, PSet_children(node)[slot], data, h,
+                        shift + PSET_BITS);
+    if (!child) {
+      return NULL;
+    }
+  }
+  PSetNode *copy = PSet_branch(set, node->bitmap | bit);
+  PSetNode **from = PSet_children(node);
+  PSetNode **to = PSet_children(copy);
+  for (size_t i = 0; i < n; i++) {
+    to[i < slot ? i : i + !(node->bitmap & bit)] = PSet_retain(from[i]);
+  }
+  if (child) {
+    PSet_release(set, to[slot]);
+    to[slot] = child;
+  } else {
+    to[slot] = PSet_leaf(set, h, data);
+  }
+  return copy;
+}
+
+// Returns a new version containing `data`; `set` itself is unchanged and
+// both must be freed.
+static inline PSet *PSet_add(const PSet *set, const void *data) {
+  uint64_t h = hash(data, set->sizeOfData, HASH_SEED);
+  PSet *result = PSet_create_with(set->sizeOfData, set->allocator);
+  result->root = PSet_insert(set, set->root, data, h, 0);
+  if (result->root) {
+    result->len = set->len + 1;
+  } else {
+    result->root = PSet_retain(set->root);
+    result->len = set->len;
+  }
+  return result;
+}
+
+static inline void *PSet_copy(const void *src) {
+  assert(src);
+  const PSet *srcSet = (const PSet *)src;
+  PSet *destSet = PSet_create_with(srcSet->sizeOfData, srcSet->allocator);
+  destSet->root = PSet_retain(srcSet->root);
+  destSet->len = srcSet->len;
+  return destSet;
+}
+
+static inline void PSet_free(void *set_void) {
+  PSet *set = (PSet *)set_void;
+  PSet_release(set, set->root);
+  free(set);
+}
@@ -0,0 +1,233 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec.h"
+
+// Monotone integer priority queues: both pop the smallest priority first
+// and require every added priority to be >= the last one popped, which
+// holds for Dijkstra-style searches with non-negative costs. Items are
+// stored inline as [priority][key][value] entries, as in Heap, and popped
+// by copying them out; no callback is ever called.
+//
+// RadixHeap keeps 65 buckets by the highest bit in which a priority
+// differs from the last popped one. Popping from an empty bucket 0
+// redistributes the first non-empty bucket into lower ones, so each item
+// moves down at most 64 times: O(log C) amortized for priorities spanning
+// C.
+//
+// BucketQueue (Dial's algorithm) keeps one bucket per priority modulo
+// nbuckets and needs pending priorities to lie within nbuckets of the last
+// popped one; add and pop are O(1) plus the scan over empty buckets.
+
+#define RADIX_BUCKETS 65
+
+static inline size_t Radix_entry_size(size_t sizeOfKey, size_t sizeOfValue,
+                                      size_t *valueOffset) {
+  size_t align = sizeof(uint64_t) - 1;
+  *valueOffset = (sizeof(uint64_t) + sizeOfKey + align) & ~align;
+  return (*valueOffset + sizeOfValue + align) & ~align;
+}
+
+static inline void Radix_store(char *entry, uint64_t priority, const void *key,
+                               size_t sizeOfKey, const void *value,
+                               size_t sizeOfValue, size_t valueOffset) {
+  memcpy(entry, &priority, sizeof(priority));
+  // zero-sized keys and values may be passed as NULL
+  if (key && sizeOfKey) {
+    memcpy(entry + sizeof(priority), key, sizeOfKey);
+  }
+  if (value && sizeOfValue) {
+    memcpy(entry + valueOffset, value, sizeOfValue);
+  }
+}
+
+static inline uint64_t Radix_priority_of(const char *entry) {
+  uint64_t priority;
+  memcpy(&priority, entry, sizeof(priority));
+  return priority;
+}
+
+// Copies the fields of `entry` to the non-NULL outputs.
+static inline void Radix_load(const char *entry, uint64_t *priority, void *key,
+                              size_t sizeOfKey, void *value, size_t sizeOfValue,
+                              size_t valueOffset) {
+  if (priority) {
+    *priority = Radix_priority_of(entry);
+  }
+  if (key) {
+    memcpy(key, entry + sizeof(uint64_t), sizeOfKey);
+  }
+  if (value) {
+    memcpy(value, entry + valueOffset, sizeOfValue);
+  }
+}
+
+typedef struct RadixHeap {
+  size_t sizeOfKey;
+  size_t sizeOfValue;
+  size_t valueOffset;
+  size_t sizeOfEntry;
+  size_t len;
+  uint64_t last;
+  Vec *buckets[RADIX_BUCKETS];
+  char *scratch;
+} RadixHeap;
+
+static inline RadixHeap *RadixHeap_create(size_t sizeOfKey,
+                                          size_t sizeOfValue) {
+  RadixHeap *heap = malloc(sizeof(RadixHeap));
+  assert(heap);
+  heap->sizeOfKey = sizeOfKey;
+  heap->sizeOfValue = sizeOfValue;
+  heap->sizeOfEntry =
+      Radix_entry_size(sizeOfKey, sizeOfValue, &heap->valueOffset);
+  heap->len = 0;
+  heap->last = 0;
+  for (int i = 0; i < RADIX_BUCKETS; i++) {
+    heap->buckets[i] = Vec_create(0, heap->sizeOfEntry);
+  }
+  heap->scratch = malloc(heap->sizeOfEntry);
+  assert(heap->scratch);
+  return heap;
+}
+
+static inline int RadixHeap_bucket(const RadixHeap *heap, uint64_t priority) {
+  uint64_t diff = priority ^ heap->last;
+  return diff ? 64 - __builtin_clzll(diff) : 0;
+}
+
+static inline void RadixHeap_add(RadixHeap *heap, uint64_t priority,
+                                 const void *key, const void *value) {
+  assert(priority >= heap->last);
+  Radix_store(heap->scratch, priority, key, heap->sizeOfKey, value,
+              heap->sizeOfValue, heap->valueOffset);
+  Vec_push(heap->buckets[RadixHeap_bucket(heap, priority)], heap->scratch);
+  heap->len++;
+}
+
+// Refills bucket 0 from the first non-empty bucket.
+static inline void RadixHeap_refill(RadixHeap *heap) {
+  int i = 1;
+  while (heap->buckets[i]->len == 0) {
+    i++;
+  }
+  Vec *bucket = heap->buckets[i];
+  uint64_t min = UINT64_MAX;
+  for (size_t j = 0; j < bucket->len; j++) {
+    uint64_t priority = Radix_priority_of(Vec_get(bucket, j));
+    if (priority < min) {
+      min = priority;
+    }
+  }
+  heap->last = min;
+  for (size_t j = 0; j < bucket->len; j++) {
+    char *entry = Vec_get(bucket, j);
+    Vec_push(heap->buckets[RadixHeap_bucket(heap, Radix_priority_of(entry))],
+             entry);
+  }
+  Vec_clear(bucket);
+}
+
+static inline uint64_t RadixHeap_peek_priority(RadixHeap *heap) {
+  assert(heap->len);
+  if (heap->buckets[0]->len == 0) {
+    RadixHeap_refill(heap);
+  }
+  return heap->last;
+}
+
+// Removes an item with the smallest priority, copying its fields to the
+// non-NULL outputs.
+static inline void RadixHeap_pop(RadixHeap *heap, uint64_t *priority, void *key,
+                                 void *value) {
+  RadixHeap_peek_priority(heap);
+  Vec *bucket = heap->buckets[0];
+  Radix_load(Vec_get(bucket, bucket->len - 1), priority, key, heap->sizeOfKey,
+             value, heap->sizeOfValue, heap->valueOffset);
+  Vec_pop(bucket, NULL);
+  heap->len--;
+}
+
+static inline void RadixHeap_free(RadixHeap *heap) {
+  for (int i = 0; i < RADIX_BUCKETS; i++) {
+    Vec_free(heap->buckets[i]);
+  }
+  free(heap->scratch);
+  free(heap);
+}
+
+typedef struct BucketQueue {
+  size_t sizeOfKey;
+  size_t sizeOfValue;
+  size_t valueOffset;
+  size_t sizeOfEntry;
+  size_t len;
+  uint64_t last;
+  size_t nbuckets;
+  Vec **buckets;
+  char *scratch;
+} BucketQueue;
+
+// Pending priorities must stay below last popped + nbuckets, i.e. nbuckets
+// should exceed the largest single step cost.
+static inline BucketQueue *BucketQueue_create(size_t nbuckets, size_t sizeOfKey,
+                                              size_t sizeOfValue) {
+  assert(nbuckets);
+  BucketQueue *queue = malloc(sizeof(BucketQueue));
+  assert(queue);
+  queue->sizeOfKey = sizeOfKey;
+  queue->sizeOfValue = sizeOfValue;
+  queue->sizeOfEntry =
+      Radix_entry_size(sizeOfKey, sizeOfValue, &queue->valueOffset);
+  queue->len = 0;
+  queue->last = 0;
+  queue->nbuckets = nbuckets;
+  queue->buckets = malloc(nbuckets * sizeof(Vec *));
+  assert(queue->buckets);
+  for (size_t i = 0; i < nbuckets; i++) {
+    queue->buckets[i] = Vec_create(0, queue->sizeOfEntry);
+  }
+  queue->scratch = malloc(queue->sizeOfEntry);
+  assert(queue->scratch);
+  return queue;
+}
+
+static inline void BucketQueue_add(BucketQueue *queue, uint64_t priority,
+                                   const void *key, const void *value) {
+  assert(priority >= queue->last && priority - queue->last < queue->nbuckets);
+  Radix_store(queue->scratch, priority, key, queue->sizeOfKey, value,
+              queue->sizeOfValue, queue->valueOffset);
+  Vec_push(queue->buckets[priority % queue->nbuckets], queue->scratch);
+  queue->len++;
+}
+
+static inline uint64_t BucketQueue_peek_priority(BucketQueue *queue) {
+  assert(queue->len);
+  while (queue->buckets[queue->last % queue->nbuckets]->len == 0) {
+    queue->last++;
+  }
+  return queue->last;
+}
+
+static inline void BucketQueue_pop(BucketQueue *queue, uint64_t *priority,
+                                   void *key, void *value) {
+  Vec *bucket =
+      queue->buckets[BucketQueue_peek_priority(queue) % queue->nbuckets];
+  Radix_load(Vec_get(bucket, bucket->len - 1), priority, key,
+             queue->sizeOfKey, value, queue->sizeOfValue, queue->valueOffset);
+  Vec_pop(bucket, NULL);
+  queue->len--;
+}
+
+static inline void BucketQueue_free(BucketQueue *queue) {
+  for (size_t i = 0; i < queue->nbuckets; i++) {
+    Vec_free(queue->buckets[i]);
+  }
+  free(queue->buckets);
+  free(queue->scratch);
+  free(queue);
+}
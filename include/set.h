@@ -1,130 +1,283 @@
+#pragma once
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "hash.h"
+#include "prof.h"
 
 #define LOAD_FACTOR 0.75
-#define DELETED ((void *)-1)
+#define REHASH_STEP 16
 
+// table[i] owns a copy of the item in slot i and ctrl[i] is its control
+// byte (hash.h). Growth is incremental: oldTable keeps the previous table
+// while its slots from rehashIndex onwards are moved into `table`,
+// REHASH_STEP per Set_add/Set_remove. Lookups check both; slots of
+// oldTable below rehashIndex have been moved and are never dereferenced
+// again. CTRL_DELETED only appears in oldCtrl.
 typedef struct Set {
   size_t sizeOfData;
   size_t len;
   size_t capacity;
+  uint64_t seed;
   void **table;
+  unsigned char *ctrl;
+  size_t oldCapacity;
+  void **oldTable;
+  unsigned char *oldCtrl;
+  size_t rehashIndex;
+  size_t rehashCount;
+  Allocator *allocator;
 } Set;
 
-Set *Set_create(size_t capacity, size_t sizeOfData) {
+static inline size_t Set_index(const Set *set, const void *data) {
+  return hash(data, set->sizeOfData, set->seed) & (set->capacity - 1);
+}
+
+// Item copies come from `allocator` (NULL for malloc).
+static inline Set *Set_create_with(size_t capacity, size_t sizeOfData,
+                                   Allocator *allocator) {
   Set *set = calloc(1, sizeof(Set));
   assert(set);
   set->sizeOfData = sizeOfData;
   set->len = 0;
+  set->seed = HASH_SEED;
   assert(capacity);
-  set->capacity = capacity;
+  set->capacity = hash_capacity(capacity);
   set->table = calloc(set->capacity, sizeof(void *));
+  set->ctrl = ctrl_alloc(set->capacity);
+  set->allocator = allocator;
   return set;
 }
 
-void Set_add(Set *set, void *data) {
-  assert(set);
-  if (set->len >= set->capacity * LOAD_FACTOR) {
-    printf("Warning: rehashing set!\n");
-    size_t capacity = set->capacity * 2;
-    void **table = calloc(capacity, sizeof(void *));
-    for (int i = 0; i < set->capacity; i++) {
-      if (set->table[i] && set->table[i] != DELETED) {
-        size_t index = hash(set->table[i], set->sizeOfData, capacity);
-        while (table[index]) {
-          index = (index + 1) % capacity;
-        }
-        table[index] = set->table[i];
+static inline Set *Set_create(size_t capacity, size_t sizeOfData) {
+  return Set_create_with(capacity, sizeOfData, NULL);
+}
+
+// Scans the control bytes of `ctrl`/`table` group by group for `data`,
+// comparing items only on tag matches before the first empty slot. Returns
+// the matching slot or the empty slot where `data` should go. Matches below
+// `start` are ignored.
+static inline size_t Set_probe_table(const Set *set, void *const *table,
+                                     const unsigned char *ctrl, size_t capacity,
+                                     const void *data, uint64_t h, size_t start,
+                                     bool *found) {
+  size_t mask = capacity - 1;
+  unsigned char tag = hash_tag(h);
+  size_t pos = h & mask;
+  PROF_COUNT("set.probe", 1);
+  while (true) {
+    unsigned int empty = ctrl_match(ctrl + pos, CTRL_EMPTY);
+    unsigned int match = ctrl_match(ctrl + pos, tag);
+    if (empty) {
+      match &= (empty & -empty) - 1;
+    }
+    while (match) {
+      size_t index = (pos + __builtin_ctz(match)) & mask;
+      if (index >= start &&
+          memcmp(table[index], data, set->sizeOfData) == 0) {
+        *found = true;
+        return index;
       }
+      match &= match - 1;
     }
-    free(set->table);
-    set->table = table;
-    set->capacity = capacity;
-  }
-  size_t index = hash(data, set->sizeOfData, set->capacity);
-  while (set->table[index]) {
-    if (set->table[index] == DELETED) {
-      index = (index + 1) % set->capacity;
-      continue;
+    if (empty) {
+      *found = false;
+      return (pos + __builtin_ctz(empty)) & mask;
     }
-    if (memcmp(set->table[index], data, set->sizeOfData) == 0) {
-      return;
+    pos = (pos + CTRL_GROUP) & mask;
+    PROF_COUNT("set.probe.next_group", 1);
+  }
+}
+
+static inline size_t Set_probe(const Set *set, const void *data, uint64_t h,
+                               bool *found) {
+  return Set_probe_table(set, set->table, set->ctrl, set->capacity, data, h,
+                         0, found);
+}
+
+// Looks `data` up in the table being drained. *index is only written on a
+// hit, so callers can keep the insertion slot of the current table in it.
+static inline bool Set_probe_old(const Set *set, const void *data, uint64_t h,
+                                 size_t *index) {
+  if (!set->oldTable) {
+    return false;
+  }
+  bool found;
+  size_t slot = Set_probe_table(set, set->oldTable, set->oldCtrl,
+                                set->oldCapacity, data, h, set->rehashIndex,
+                                &found);
+  if (found) {
+    *index = slot;
+  }
+  return found;
+}
+
+static inline void Set_rehash_step(Set *set, size_t steps) {
+  if (!set->oldTable) {
+    return;
+  }
+  for (; steps && set->rehashIndex < set->oldCapacity; steps--) {
+    size_t i = set->rehashIndex++;
+    if (ctrl_full(set->oldCtrl[i])) {
+      void *item = set->oldTable[i];
+      PROF_COUNT("set.rehash.move", 1);
+      uint64_t h = hash(item, set->sizeOfData, set->seed);
+      bool found;
+      size_t index = Set_probe(set, item, h, &found);
+      set->table[index] = item;
+      ctrl_set(set->ctrl, set->capacity, index, hash_tag(h));
     }
-    index = (index + 1) % set->capacity;
   }
-  void *item = copy_hashable(data, set->sizeOfData);
-  set->table[index] = item;
-  set->len++;
+  if (set->rehashIndex == set->oldCapacity) {
+    free(set->oldTable);
+    free(set->oldCtrl);
+    set->oldTable = NULL;
+    set->oldCtrl = NULL;
+    set->oldCapacity = 0;
+    set->rehashIndex = 0;
+  }
 }
 
-bool Set_find(const Set *set, void *data) {
-  size_t index = hash(data, set->sizeOfData, set->capacity);
-  while (set->table[index]) {
-    if (set->table[index] == DELETED) {
-      index = (index + 1) % set->capacity;
-      continue;
+static inline void Set_grow(Set *set) {
+  Set_rehash_step(set, SIZE_MAX);
+  PROF_COUNT("set.grow", 1);
+  set->oldTable = set->table;
+  set->oldCtrl = set->ctrl;
+  set->oldCapacity = set->capacity;
+  set->rehashIndex = 0;
+  set->rehashCount++;
+  set->capacity *= 2;
+  set->table = calloc(set->capacity, sizeof(void *));
+  set->ctrl = ctrl_alloc(set->capacity);
+  assert(set->table && set->ctrl);
+}
+
+// Allocation-free iteration: start with `size_t cursor = 0` and call until
+// it returns NULL. The set must not be modified while iterating.
+static inline void *Set_iter_next(const Set *set, size_t *cursor) {
+  while (*cursor < set->capacity) {
+    size_t i = (*cursor)++;
+    if (ctrl_full(set->ctrl[i])) {
+      return set->table[i];
     }
-    if (memcmp(set->table[index], data, set->sizeOfData) == 0) {
-      return true;
+  }
+  while (*cursor - set->capacity < set->oldCapacity) {
+    size_t i = (*cursor)++ - set->capacity;
+    if (i >= set->rehashIndex && ctrl_full(set->oldCtrl[i])) {
+      return set->oldTable[i];
     }
-    index = (index + 1) % set->capacity;
   }
-  return false;
+  return NULL;
+}
+
+static inline void Set_add(Set *set, void *data) {
+  assert(set);
+  Set_rehash_step(set, REHASH_STEP);
+  uint64_t h = hash(data, set->sizeOfData, set->seed);
+  bool found;
+  size_t index = Set_probe(set, data, h, &found);
+  if (found || Set_probe_old(set, data, h, &index)) {
+    return;
+  }
+  if (set->len >= set->capacity * LOAD_FACTOR) {
+    Set_grow(set);
+    index = Set_probe(set, data, h, &found);
+  }
+  set->table[index] =
+      Allocator_copy(set->allocator, data, set->sizeOfData);
+  ctrl_set(set->ctrl, set->capacity, index, hash_tag(h));
+  set->len++;
 }
 
-void **Set_items(const Set *set) {
+static inline bool Set_find(const Set *set, void *data) {
+  uint64_t h = hash(data, set->sizeOfData, set->seed);
+  bool found;
+  size_t index;
+  Set_probe(set, data, h, &found);
+  return found || Set_probe_old(set, data, h, &index);
+}
+
+static inline void **Set_items(const Set *set) {
   void **items = calloc(set->len, sizeof(void *));
   assert(items);
   size_t index = 0;
-  for (int i = 0; i < set->capacity; i++) {
-    if (set->table[i] && set->table[i] != DELETED) {
-      items[index++] = set->table[i];
-    }
+  size_t cursor = 0;
+  void *item;
+  while ((item = Set_iter_next(set, &cursor))) {
+    items[index++] = item;
   }
   return items;
 }
 
-void Set_free(void *set_void) {
+static inline void Set_free(void *set_void) {
   Set *set = (Set *)set_void;
-  for (int i = 0; i < set->capacity; i++) {
-    if (set->table[i] && set->table[i] != DELETED) {
-      free(set->table[i]);
-    }
+  size_t cursor = 0;
+  void *item;
+  while (Allocator_frees(set->allocator) &&
+         (item = Set_iter_next(set, &cursor))) {
+    Allocator_free(set->allocator, item, set->sizeOfData);
   }
   free(set->table);
+  free(set->ctrl);
+  free(set->oldTable);
+  free(set->oldCtrl);
   free(set);
 }
 
-void *Set_return(const void *src) { return src; }
+static inline void *Set_return(const void *src) { return src; }
 
-void *Set_copy(const void *src) {
+static inline void *Set_copy(const void *src) {
   assert(src);
   Set *srcSet = (Set *)src;
-  Set *destSet = Set_create(srcSet->capacity, srcSet->sizeOfData);
-  for (size_t i = 0; i < srcSet->capacity; i++) {
-    if (srcSet->table[i] && srcSet->table[i] != DELETED) {
-      Set_add(destSet, srcSet->table[i]);
-    }
+  Set *destSet =
+      Set_create_with(srcSet->capacity, srcSet->sizeOfData, srcSet->allocator);
+  size_t cursor = 0;
+  void *item;
+  while ((item = Set_iter_next(srcSet, &cursor))) {
+    Set_add(destSet, item);
   }
   return destSet;
 }
 
-void Set_remove(Set *set, const void *data) {
-  size_t index = hash(data, set->sizeOfData, set->capacity);
-  assert(Set_find(set, data));
-  while (set->table[index] && set->table[index] != DELETED) {
-    if (memcmp(set->table[index], data, set->sizeOfData) == 0) {
-      free(set->table[index]);
-      set->table[index] = DELETED;
-      set->len--;
+// Backward-shift deletion: entries after the removed one move back into
+// the hole unless their home slot lies cyclically between the hole and
+// their current slot, so probes never need tombstones. Items still waiting
+// in oldTable get a tombstone instead, since shifting there could move
+// unmigrated items below rehashIndex. Removing an absent item does
+// nothing.
+static inline void Set_remove(Set *set, const void *data) {
+  Set_rehash_step(set, REHASH_STEP);
+  uint64_t h = hash(data, set->sizeOfData, set->seed);
+  bool found;
+  size_t index = Set_probe(set, data, h, &found);
+  if (!found) {
+    if (!Set_probe_old(set, data, h, &index)) {
       return;
     }
-    index = (index + 1) % set->capacity;
+    Allocator_free(set->allocator, set->oldTable[index], set->sizeOfData);
+    ctrl_set(set->oldCtrl, set->oldCapacity, index, CTRL_DELETED);
+    set->len--;
+    return;
   }
-  return;
-}
\ No newline at end of file
+  Allocator_free(set->allocator, set->table[index], set->sizeOfData);
+  size_t mask = set->capacity - 1;
+  size_t hole = index;
+  size_t next = (hole + 1) & mask;
+  while (set->ctrl[next] != CTRL_EMPTY) {
+    size_t home = Set_index(set, set->table[next]);
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      set->table[hole] = set->table[next];
+      ctrl_set(set->ctrl, set->capacity, hole, set->ctrl[next]);
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  set->table[hole] = NULL;
+  ctrl_set(set->ctrl, set->capacity, hole, CTRL_EMPTY);
+  set->len--;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "input.h"
+#include "prof.h"
+
+// Common entry point of the days: `void solve(const Input *, Result *)`
+// reads the whole puzzle from the input and records one formatted answer
+// per part with Result_add. The same source builds both the standalone
+// 2025_N.exe, whose main comes from SOLVE_MAIN, and, with AOC_LIBRARY
+// defined, the library behind the `aoc` runner.
+
+#define RESULT_PARTS 4
+#define RESULT_ANSWER 64
+
+typedef struct Result {
+  int nparts;
+  char parts[RESULT_PARTS][RESULT_ANSWER];
+  // seconds from Result_init to each Result_add
+  double times[RESULT_PARTS];
+  double start;
+  // answers are also printed here as they come in, if set
+  FILE *echo;
+} Result;
+
+typedef void (*Solver)(const Input *input, Result *result);
+
+static inline double solve_clock(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline void Result_init(Result *result, FILE *echo) {
+  result->nparts = 0;
+  result->start = solve_clock();
+  result->echo = echo;
+}
+
+static inline void Result_add(Result *result, const char *format, ...) {
+  assert(result->nparts < RESULT_PARTS);
+  char *answer = result->parts[result->nparts];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(answer, RESULT_ANSWER, format, args);
+  va_end(args);
+  result->times[result->nparts++] = solve_clock() - result->start;
+  if (result->echo) {
+    fprintf(result->echo, "%s\n", answer);
+    fflush(result->echo);
+  }
+}
+
+// main of a standalone day: solves the input named by argv[1] (standard
+// input if absent) and prints the answers one per line. Built with -DPROF
+// it also prints the phases and counters to standard error.
+static inline int solve_main(int argc, char **argv, Solver solve) {
+  PROF_PHASE("read");
+  Input *input = Input_open(argc > 1 ? argv[1] : NULL);
+  PROF_PHASE_END();
+  Result result;
+  Result_init(&result, stdout);
+  solve(input, &result);
+  PROF_PHASE_END();
+  Input_free(input);
+  PROF_REPORT(stderr);
+  return 0;
+}
+
+#ifdef AOC_LIBRARY
+#define SOLVE_MAIN(solve)
+#else
+#define SOLVE_MAIN(solve)                                                      \
+  int main(int argc, char **argv) { return solve_main(argc, argv, solve); }
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+
+// Growable array storing elements inline and contiguously: O(1) Vec_get,
+// amortized O(1) Vec_push. Use it instead of List when elements are only
+// appended and indexed. Pointers returned by Vec_get/Vec_push are
+// invalidated by the next operation that may reallocate (push, reserve,
+// shrink).
+typedef struct Vec {
+  size_t sizeOfData;
+  size_t len;
+  size_t capacity;
+  char *data;
+} Vec;
+
+static inline Vec *Vec_create(size_t capacity, size_t sizeOfData) {
+  Vec *vec = malloc(sizeof(Vec));
+  assert(vec);
+  vec->sizeOfData = sizeOfData;
+  vec->len = 0;
+  vec->capacity = capacity;
+  vec->data = capacity ? malloc(capacity * sizeOfData) : NULL;
+  assert(vec->data || !capacity);
+  return vec;
+}
+
+// Makes room for at least `capacity` elements without further reallocation.
+static inline void Vec_reserve(Vec *vec, size_t capacity) {
+  if (capacity <= vec->capacity) {
+    return;
+  }
+  vec->data = realloc(vec->data, capacity * vec->sizeOfData);
+  assert(vec->data);
+  vec->capacity = capacity;
+}
+
+// Releases unused capacity.
+static inline void Vec_shrink(Vec *vec) {
+  if (vec->len == vec->capacity) {
+    return;
+  }
+  if (vec->len == 0) {
+    free(vec->data);
+    vec->data = NULL;
+  } else {
+    vec->data = realloc(vec->data, vec->len * vec->sizeOfData);
+    assert(vec->data);
+  }
+  vec->capacity = vec->len;
+}
+
+static inline void *Vec_get(const Vec *vec, size_t index) {
+  assert(index < vec->len);
+  return vec->data + index * vec->sizeOfData;
+}
+
+// Appends a copy of `data` and returns the stored element.
+static inline void *Vec_push(Vec *vec, const void *data) {
+  if (vec->len == vec->capacity) {
+    Vec_reserve(vec, vec->capacity ? vec->capacity * 2 : 8);
+  }
+  void *slot = vec->data + vec->len++ * vec->sizeOfData;
+  memcpy(slot, data, vec->sizeOfData);
+  return slot;
+}
+
+// Removes the last element, copying it to `out` unless `out` is NULL.
+static inline void Vec_pop(Vec *vec, void *out) {
+  assert(vec->len);
+  vec->len--;
+  if (out) {
+    memcpy(out, vec->data + vec->len * vec->sizeOfData, vec->sizeOfData);
+  }
+}
+
+// O(1) removal that moves the last element into `index`; does not keep
+// the order.
+static inline void Vec_swap_remove(Vec *vec, size_t index) {
+  assert(index < vec->len);
+  vec->len--;
+  if (index != vec->len) {
+    memcpy(vec->data + index * vec->sizeOfData,
+           vec->data + vec->len * vec->sizeOfData, vec->sizeOfData);
+  }
+}
+
+static inline void Vec_sort(Vec *vec,
+                            int (*compare)(const void *, const void *)) {
+  if (vec->len > 1) {
+    qsort(vec->data, vec->len, vec->sizeOfData, compare);
+  }
+}
+
+static inline void Vec_clear(Vec *vec) { vec->len = 0; }
+
+static inline void *Vec_copy(const void *src) {
+  assert(src);
+  const Vec *srcVec = (const Vec *)src;
+  Vec *destVec = Vec_create(srcVec->len, srcVec->sizeOfData);
+  if (srcVec->len) {
+    memcpy(destVec->data, srcVec->data, srcVec->len * srcVec->sizeOfData);
+  }
+  destVec->len = srcVec->len;
+  return destVec;
+}
+
+static inline void Vec_free(void *vec_void) {
+  Vec *vec = (Vec *)vec_void;
+  free(vec->data);
+  free(vec);
+}